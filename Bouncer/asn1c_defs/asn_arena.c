@@ -0,0 +1,209 @@
+/*
+ * Bump allocator for the ASN.1 support code, see asn_arena.h.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <asn_arena.h>
+
+#define	ASN_ARENA_ALIGN		16
+#define	ASN_ARENA_ROUND(size)	(((size) + ASN_ARENA_ALIGN - 1) & ~((size_t)ASN_ARENA_ALIGN - 1))
+
+typedef struct asn_arena_chunk_s {
+	struct asn_arena_chunk_s *next;
+	size_t size;	/* Usable bytes */
+	size_t used;	/* Bytes handed out, including block headers */
+} asn_arena_chunk_t;
+
+/*
+ * Every block is preceded by its requested size, which REALLOC() needs
+ * to know how much to copy.
+ */
+#define	ASN_ARENA_CHUNK_HDR	ASN_ARENA_ROUND(sizeof(asn_arena_chunk_t))
+#define	ASN_ARENA_BLOCK_HDR	ASN_ARENA_ROUND(sizeof(size_t))
+#define	ASN_ARENA_DATA(chunk)	((char *)(chunk) + ASN_ARENA_CHUNK_HDR)
+#define	ASN_ARENA_SIZE(ptr)	(*(size_t *)((char *)(ptr) - ASN_ARENA_BLOCK_HDR))
+
+static __thread asn_arena_t *asn_arena_current;
+
+asn_arena_t *
+asn_arena_use(asn_arena_t *arena) {
+	asn_arena_t *previous = asn_arena_current;
+	asn_arena_current = arena;
+	return previous;
+}
+
+static asn_arena_chunk_t *
+asn_arena_new_chunk(asn_arena_t *arena, size_t size) {
+	asn_arena_chunk_t *chunk;
+
+	if(size < ASN_ARENA_CHUNK_SIZE)
+		size = ASN_ARENA_CHUNK_SIZE;
+
+	chunk = (asn_arena_chunk_t *)malloc(ASN_ARENA_CHUNK_HDR + size);
+	if(!chunk)
+		return NULL;
+
+	chunk->next = arena->chunks;
+	chunk->size = size;
+	chunk->used = 0;
+	arena->chunks = chunk;
+	arena->total += size;
+
+	return chunk;
+}
+
+static void
+asn_arena_release(asn_arena_t *arena) {
+	asn_arena_chunk_t *chunk = arena->chunks;
+
+	while(chunk) {
+		asn_arena_chunk_t *next = chunk->next;
+		free(chunk);
+		chunk = next;
+	}
+
+	arena->chunks = 0;
+	arena->total = 0;
+	arena->last = 0;
+}
+
+void
+asn_arena_reset(asn_arena_t *arena) {
+	if(!arena)
+		return;
+
+	if(arena->chunks && arena->chunks->next) {
+		/* The round did not fit, replace the chunks with a single one */
+		size_t total = arena->total;
+		asn_arena_release(arena);
+		(void)asn_arena_new_chunk(arena, total);
+	} else if(arena->chunks) {
+		arena->chunks->used = 0;
+	}
+
+	arena->last = 0;
+}
+
+void
+asn_arena_destroy(asn_arena_t *arena) {
+	if(arena)
+		asn_arena_release(arena);
+}
+
+static int
+asn_arena_owns(const asn_arena_t *arena, const void *ptr) {
+	const asn_arena_chunk_t *chunk;
+
+	for(chunk = arena->chunks; chunk; chunk = chunk->next) {
+		const char *data = ASN_ARENA_DATA(chunk);
+		if((const char *)ptr >= data && (const char *)ptr < data + chunk->size)
+			return 1;
+	}
+
+	return 0;
+}
+
+static void *
+asn_arena_alloc(asn_arena_t *arena, size_t size) {
+	asn_arena_chunk_t *chunk = arena->chunks;
+	size_t need;
+	char *block;
+
+	if(size > SIZE_MAX - 2 * ASN_ARENA_ALIGN)
+		return NULL;
+	need = ASN_ARENA_BLOCK_HDR + ASN_ARENA_ROUND(size);
+
+	if(!chunk || chunk->size - chunk->used < need) {
+		chunk = asn_arena_new_chunk(arena, need);
+		if(!chunk)
+			return NULL;
+	}
+
+	block = ASN_ARENA_DATA(chunk) + chunk->used + ASN_ARENA_BLOCK_HDR;
+	ASN_ARENA_SIZE(block) = size;
+	chunk->used += need;
+	arena->last = block;
+
+	return block;
+}
+
+void *
+asn_arena_malloc(size_t size) {
+	asn_arena_t *arena = asn_arena_current;
+
+	if(!arena)
+		return malloc(size);
+
+	return asn_arena_alloc(arena, size);
+}
+
+void *
+asn_arena_calloc(size_t nmemb, size_t size) {
+	asn_arena_t *arena = asn_arena_current;
+	void *ptr;
+
+	if(!arena)
+		return calloc(nmemb, size);
+
+	if(size && nmemb > SIZE_MAX / size)
+		return NULL;
+
+	ptr = asn_arena_alloc(arena, nmemb * size);
+	if(ptr)
+		memset(ptr, 0, nmemb * size);
+
+	return ptr;
+}
+
+void *
+asn_arena_realloc(void *ptr, size_t size) {
+	asn_arena_t *arena = asn_arena_current;
+	size_t old_size;
+	void *nptr;
+
+	if(!arena || (ptr && !asn_arena_owns(arena, ptr)))
+		return realloc(ptr, size);
+
+	if(!ptr)
+		return asn_arena_alloc(arena, size);
+
+	old_size = ASN_ARENA_SIZE(ptr);
+
+	if(ptr == arena->last && size <= SIZE_MAX - 2 * ASN_ARENA_ALIGN) {
+		/* The most recent block grows in place while the chunk has room */
+		asn_arena_chunk_t *chunk = arena->chunks;
+		size_t start = (char *)ptr - ASN_ARENA_DATA(chunk);
+		if(start + ASN_ARENA_ROUND(size) <= chunk->size) {
+			chunk->used = start + ASN_ARENA_ROUND(size);
+			ASN_ARENA_SIZE(ptr) = size;
+			return ptr;
+		}
+	}
+
+	nptr = asn_arena_alloc(arena, size);
+	if(nptr)
+		memcpy(nptr, ptr, old_size < size ? old_size : size);
+
+	return nptr;
+}
+
+void
+asn_arena_free(void *ptr) {
+	asn_arena_t *arena = asn_arena_current;
+
+	if(!ptr)
+		return;
+
+	if(!arena || !asn_arena_owns(arena, ptr)) {
+		free(ptr);
+		return;
+	}
+
+	if(ptr == arena->last) {
+		/* Give back the most recent block, common for temporary buffers */
+		asn_arena_chunk_t *chunk = arena->chunks;
+		chunk->used = ((char *)ptr - ASN_ARENA_BLOCK_HDR) - ASN_ARENA_DATA(chunk);
+		arena->last = 0;
+	}
+}
@@ -0,0 +1,65 @@
+/*
+ * Bump allocator backing the CALLOC/MALLOC/REALLOC/FREEMEM hooks of
+ * asn_internal.h when compiled with -DASN_ARENA_ALLOCATOR.
+ *
+ * An arena is made current for the calling thread with asn_arena_use().
+ * While it is current, every allocation made by the ASN.1 support code is
+ * carved out of the arena chunks, and FREEMEM() of arena memory is a no-op.
+ * All of it is released at once by asn_arena_reset(), which keeps the chunks
+ * for the next round, so a steady stream of similar messages is decoded and
+ * encoded without touching the heap.
+ *
+ * Without a current arena the hooks fall back to the C library, and pointers
+ * not owned by the current arena are always handed to free()/realloc(),
+ * hence heap and arena memory may be mixed within the same structure.
+ * Arena memory must not be released after the arena is no longer current.
+ */
+#ifndef	ASN_ARENA_H
+#define	ASN_ARENA_H
+
+#include <stddef.h>
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#define	ASN_ARENA_CHUNK_SIZE	4096	/* Minimum usable size of a chunk */
+
+struct asn_arena_chunk_s;
+
+typedef struct asn_arena_s {
+	struct asn_arena_chunk_s *chunks;	/* The chunk being filled comes first */
+	size_t total;				/* Usable bytes in all chunks */
+	void *last;				/* Most recent allocation */
+} asn_arena_t;
+
+#define	ASN_ARENA_INITIALIZER	{ 0, 0, 0 }
+
+/*
+ * Make the arena current for the calling thread, NULL restores the heap.
+ * RETURN VALUES:
+ * The arena that was current before the call.
+ */
+asn_arena_t *asn_arena_use(asn_arena_t *arena);
+
+/*
+ * Release everything allocated from the arena while keeping its memory.
+ * Chunks are coalesced into a single one large enough for the whole round.
+ */
+void asn_arena_reset(asn_arena_t *arena);
+
+/*
+ * Return all the memory of the arena to the heap.
+ */
+void asn_arena_destroy(asn_arena_t *arena);
+
+void *asn_arena_malloc(size_t size);
+void *asn_arena_calloc(size_t nmemb, size_t size);
+void *asn_arena_realloc(void *ptr, size_t size);
+void asn_arena_free(void *ptr);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* ASN_ARENA_H */
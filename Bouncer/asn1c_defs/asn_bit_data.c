@@ -7,6 +7,61 @@
 #include <asn_internal.h>
 #include <asn_bit_data.h>
 
+/*
+ * The bit I/O below moves up to 64 bits at a time through a big-endian
+ * word instead of assembling the bits one octet after the other.
+ */
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) \
+	&& __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define	ASN_BE64(w)	__builtin_bswap64(w)
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) \
+	&& __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define	ASN_BE64(w)	(w)
+#endif
+
+/*
+ * Load the (size) octets available at (buf), at most 8, into the most
+ * significant end of a word.
+ */
+static inline uint64_t
+asn_load_word(const uint8_t *buf, size_t size) {
+	uint64_t word = 0;
+	size_t i;
+
+#ifdef	ASN_BE64
+	if(size >= 8) {
+		memcpy(&word, buf, 8);
+		return ASN_BE64(word);
+	}
+#endif
+	if(size > 8) size = 8;
+	for(i = 0; i < size; i++)
+		word |= (uint64_t)buf[i] << (56 - 8 * i);
+
+	return word;
+}
+
+/*
+ * Store the (size) most significant octets of a word, at most 8.
+ * With (room) for all 8 octets they are stored at once.
+ */
+static inline void
+asn_store_word(uint8_t *buf, uint64_t word, size_t size, size_t room) {
+	size_t i;
+
+#ifdef	ASN_BE64
+	if(room >= 8) {
+		word = ASN_BE64(word);
+		memcpy(buf, &word, 8);
+		return;
+	}
+#else
+	(void)room;
+#endif
+	for(i = 0; i < size; i++)
+		buf[i] = (uint8_t)(word >> (56 - 8 * i));
+}
+
 /*
  * Create a contiguous non-refillable bit data structure.
  * Can be freed by FREEMEM().
@@ -56,6 +111,30 @@ asn_get_undo(asn_bit_data_t *pd, int nbits) {
 	}
 }
 
+/*
+ * The stream holds less than (nbits), the rest comes from refill().
+ * Kept apart so that the common case does not pay for the recursion.
+ */
+static int32_t CC_ATTRIBUTE(noinline)
+asn_get_few_bits_refill(asn_bit_data_t *pd, int nbits, ssize_t nleft) {
+	int32_t tailv, vhead;
+
+	if(!pd->refill || nbits > 31) return -1;
+	/* Accumulate unused bytes before refill */
+	ASN_DEBUG("Obtain the rest %d bits (want %d)",
+		(int)nleft, (int)nbits);
+	tailv = asn_get_few_bits(pd, nleft);
+	if(tailv < 0) return -1;
+	/* Refill (replace pd contents with new data) */
+	if(pd->refill(pd))
+		return -1;
+	nbits -= nleft;
+	vhead = asn_get_few_bits(pd, nbits);
+	/* Combine the rest of previous pd with the head of new one */
+	tailv = (tailv << nbits) | vhead;  /* Could == -1 */
+	return tailv;
+}
+
 /*
  * Extract a small number of bits (<= 31) from the specified PER data pointer.
  */
@@ -66,27 +145,12 @@ asn_get_few_bits(asn_bit_data_t *pd, int nbits) {
 	uint32_t accum;
 	const uint8_t *buf;
 
-	if(nbits < 0)
+	if(nbits < 0 || nbits > 31)
 		return -1;
 
 	nleft = pd->nbits - pd->nboff;
-	if(nbits > nleft) {
-		int32_t tailv, vhead;
-		if(!pd->refill || nbits > 31) return -1;
-		/* Accumulate unused bytes before refill */
-		ASN_DEBUG("Obtain the rest %d bits (want %d)",
-			(int)nleft, (int)nbits);
-		tailv = asn_get_few_bits(pd, nleft);
-		if(tailv < 0) return -1;
-		/* Refill (replace pd contents with new data) */
-		if(pd->refill(pd))
-			return -1;
-		nbits -= nleft;
-		vhead = asn_get_few_bits(pd, nbits);
-		/* Combine the rest of previous pd with the head of new one */
-		tailv = (tailv << nbits) | vhead;  /* Could == -1 */
-		return tailv;
-	}
+	if(nbits > nleft)
+		return asn_get_few_bits_refill(pd, nbits, nleft);
 
 	/*
 	 * Normalize position indicator.
@@ -102,31 +166,15 @@ asn_get_few_bits(asn_bit_data_t *pd, int nbits) {
 	buf = pd->buffer;
 
 	/*
-	 * Extract specified number of bits.
+	 * Extract specified number of bits, at most 7 + 31 of them
+	 * are spanned from the start of the current octet.
 	 */
 	if(off <= 8)
 		accum = nbits ? (buf[0]) >> (8 - off) : 0;
 	else if(off <= 16)
 		accum = ((buf[0] << 8) + buf[1]) >> (16 - off);
-	else if(off <= 24)
-		accum = ((buf[0] << 16) + (buf[1] << 8) + buf[2]) >> (24 - off);
-	else if(off <= 31)
-		accum = (((uint32_t)buf[0] << 24) + (buf[1] << 16)
-			+ (buf[2] << 8) + (buf[3])) >> (32 - off);
-	else if(nbits <= 31) {
-		asn_bit_data_t tpd = *pd;
-		/* Here are we with our 31-bits limit plus 1..7 bits offset. */
-		asn_get_undo(&tpd, nbits);
-		/* The number of available bits in the stream allow
-		 * for the following operations to take place without
-		 * invoking the ->refill() function */
-		accum  = asn_get_few_bits(&tpd, nbits - 24) << 24;
-		accum |= asn_get_few_bits(&tpd, 24);
-	} else {
-		asn_get_undo(pd, nbits);
-		return -1;
-	}
-
+	else
+		accum = (uint32_t)(asn_load_word(buf, (pd->nbits + 7) >> 3) >> (64 - off));
 	accum &= (((uint32_t)1 << nbits) - 1);
 
 	ASN_DEBUG("  [PER got %2d<=%2d bits => span %d %+ld[%d..%d]:%02x (%d) => 0x%x]",
@@ -156,6 +204,40 @@ asn_get_many_bits(asn_bit_data_t *pd, uint8_t *dst, int alright, int nbits) {
 		nbits &= ~7;
 	}
 
+	if(nbits >= 8 && (size_t)nbits <= pd->nbits - pd->nboff) {
+		/* All the octets are in the stream, copy them in bulk */
+		size_t nbytes = nbits >> 3;
+		size_t avail;
+		size_t shift;
+		size_t i = 0;
+		const uint8_t *buf;
+
+		if(pd->nboff >= 8) {
+			pd->buffer += (pd->nboff >> 3);
+			pd->nbits  -= (pd->nboff & ~0x07);
+			pd->nboff  &= 0x07;
+		}
+		buf = pd->buffer;
+		shift = pd->nboff;
+		avail = (pd->nbits + 7) >> 3;
+
+		if(!shift) {
+			memcpy(dst, buf, nbytes);
+		} else {
+			for(; i + 7 <= nbytes && i + 8 <= avail; i += 7) {
+				uint64_t word = asn_load_word(buf + i, 8) << shift;
+				asn_store_word(dst + i, word, 7, nbytes - i);
+			}
+			for(; i < nbytes; i++)
+				dst[i] = (buf[i] << shift) | (buf[i + 1] >> (8 - shift));
+		}
+
+		pd->nboff += nbytes << 3;
+		pd->moved += nbytes << 3;
+		dst += nbytes;
+		nbits &= 0x07;
+	}
+
 	while(nbits) {
 		if(nbits >= 24) {
 			value = asn_get_few_bits(pd, 24);
@@ -185,6 +267,29 @@ asn_get_many_bits(asn_bit_data_t *pd, uint8_t *dst, int alright, int nbits) {
 	return 0;
 }
 
+/*
+ * Output the complete octets of (tmpspace), the partial one is moved
+ * to its start.
+ */
+static int CC_ATTRIBUTE(noinline)
+asn_put_flush_complete(asn_bit_outp_t *po) {
+	size_t complete_bytes;
+
+	if(!po->buffer) po->buffer = po->tmpspace;
+	complete_bytes = (po->buffer - po->tmpspace);
+	ASN_DEBUG("[PER output %ld complete + %ld]",
+		(long)complete_bytes, (long)po->flushed_bytes);
+	if(po->output(po->tmpspace, complete_bytes, po->op_key) < 0)
+		return -1;
+	if(po->nboff)
+		po->tmpspace[0] = po->buffer[0];
+	po->buffer = po->tmpspace;
+	po->nbits = 8 * sizeof(po->tmpspace);
+	po->flushed_bytes += complete_bytes;
+
+	return 0;
+}
+
 /*
  * Put a small number of bits (<= 31).
  */
@@ -212,18 +317,8 @@ asn_put_few_bits(asn_bit_outp_t *po, uint32_t bits, int obits) {
 	 * Flush whole-bytes output, if necessary.
 	 */
 	if(po->nboff + obits > po->nbits) {
-		size_t complete_bytes;
-		if(!po->buffer) po->buffer = po->tmpspace;
-		complete_bytes = (po->buffer - po->tmpspace);
-		ASN_DEBUG("[PER output %ld complete + %ld]",
-			(long)complete_bytes, (long)po->flushed_bytes);
-		if(po->output(po->tmpspace, complete_bytes, po->op_key) < 0)
+		if(asn_put_flush_complete(po))
 			return -1;
-		if(po->nboff)
-			po->tmpspace[0] = po->buffer[0];
-		po->buffer = po->tmpspace;
-		po->nbits = 8 * sizeof(po->tmpspace);
-		po->flushed_bytes += complete_bytes;
 	}
 
 	/*
@@ -242,32 +337,18 @@ asn_put_few_bits(asn_bit_outp_t *po, uint32_t bits, int obits) {
 		buf[0], (int)(omsk&0xff),
 		(int)(buf[0] & omsk));
 
+	/* At most 7 + 31 bits, written along with the start of the octet */
 	if(off <= 8)	/* Completely within 1 byte */
-		po->nboff = off,
-		bits <<= (8 - off),
-		buf[0] = (buf[0] & omsk) | bits;
+		buf[0] = (buf[0] & omsk) | (bits << (8 - off));
 	else if(off <= 16)
-		po->nboff = off,
 		bits <<= (16 - off),
 		buf[0] = (buf[0] & omsk) | (bits >> 8),
 		buf[1] = bits;
-	else if(off <= 24)
-		po->nboff = off,
-		bits <<= (24 - off),
-		buf[0] = (buf[0] & omsk) | (bits >> 16),
-		buf[1] = bits >> 8,
-		buf[2] = bits;
-	else if(off <= 31)
-		po->nboff = off,
-		bits <<= (32 - off),
-		buf[0] = (buf[0] & omsk) | (bits >> 24),
-		buf[1] = bits >> 16,
-		buf[2] = bits >> 8,
-		buf[3] = bits;
-	else {
-		if(asn_put_few_bits(po, bits >> (obits - 24), 24)) return -1;
-		if(asn_put_few_bits(po, bits, obits - 24)) return -1;
-	}
+	else
+		asn_store_word(buf,
+			((uint64_t)(buf[0] & omsk & 0xff) << 56) | ((uint64_t)bits << (64 - off)),
+			(off + 7) >> 3, (po->tmpspace + sizeof(po->tmpspace)) - buf);
+	po->nboff = off;
 
 	ASN_DEBUG("[PER out %u/%x => %02x buf+%ld]",
 		(int)bits, (int)bits, buf[0],
@@ -283,6 +364,38 @@ asn_put_few_bits(asn_bit_outp_t *po, uint32_t bits, int obits) {
 int
 asn_put_many_bits(asn_bit_outp_t *po, const uint8_t *src, int nbits) {
 
+	if(nbits >= 8 && !(po->nboff & 0x07)) {
+		/* Octet aligned, whole octets are copied in bulk */
+		size_t nbytes = nbits >> 3;
+
+		if(po->nboff >= 8) {
+			po->buffer += (po->nboff >> 3);
+			po->nbits  -= (po->nboff & ~0x07);
+			po->nboff  = 0;
+		}
+		if(!po->buffer) po->buffer = po->tmpspace;
+
+		if(nbytes > (po->nbits >> 3)) {
+			if(asn_put_flush_complete(po))
+				return -1;
+
+			if(nbytes >= sizeof(po->tmpspace)) {
+				/* Too large for (tmpspace), output straight from (src) */
+				if(po->output(src, nbytes, po->op_key) < 0)
+					return -1;
+				po->flushed_bytes += nbytes;
+				src += nbytes;
+				nbytes = 0;
+			}
+		}
+
+		memcpy(po->buffer, src, nbytes);
+		po->buffer += nbytes;
+		po->nbits -= nbytes << 3;
+		src += nbytes;
+		nbits &= 0x07;
+	}
+
 	while(nbits) {
 		uint32_t value;
 
@@ -54,9 +54,12 @@ int main(int argc, char *argv[]) {
 
 	//getting the listening port and xapp name info
 	std::string  port = config[XappSettings::SettingName::BOUNCER_PORT];
+	int msg_size = std::stoi(config[XappSettings::SettingName::MSG_MAX_BUFFER]);
 
 	//initialize rmr
-	std::unique_ptr<XappRmr> rmr = std::make_unique<XappRmr>(port);
+	std::unique_ptr<XappRmr> rmr = std::make_unique<XappRmr>(port, msg_size);
+	drop_policy_t drop_policy = config[XappSettings::SettingName::RETRY_DROP_POLICY].compare("newest") == 0 ? DROP_NEWEST : DROP_OLDEST;
+	rmr->set_retry_queue(std::stoul(config[XappSettings::SettingName::RETRY_QUEUE_SIZE]), drop_policy);
 	rmr->xapp_rmr_init(true);
 
 
@@ -90,12 +93,10 @@ int main(int argc, char *argv[]) {
 
 	//start listener threads and register message handlers.
 	int num_threads = std::stoi(config[XappSettings::SettingName::THREADS]);
-	if (num_threads > 1) {
-		mdclog_write(MDCLOG_WARN, "Using default number of threads = 1. Multithreading on xapp receiver is not supported yet.");
-	}
 	mdclog_write(MDCLOG_INFO, "Starting Listener Threads. Number of Workers = %d", num_threads);
 
 	std::unique_ptr<XappMsgHandler> mp_handler = std::make_unique<XappMsgHandler>(config[XappSettings::SettingName::XAPP_ID], sub_handler);
+	mp_handler->set_fast_control_encoder(config[XappSettings::SettingName::CONTROL_ENCODER].compare("asn1c") != 0);
 
 	b_xapp->start_xapp_receiver(std::ref(*mp_handler), num_threads);
 
@@ -0,0 +1,157 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+
+/*
+ * alloc_check.cc
+ *
+ * Checks that the xapp answers RIC indications without any heap allocation once warmed up,
+ * run with "make check-allocs".
+ *
+ * Indications of every UEID shape and header format in bench_msgs are copied into an rmr
+ * message and handed to XappMsgHandler, the way the receivers do, with both control request
+ * encoders. The first rounds fill the per worker caches, the allocations of the rounds after
+ * them are counted. Exits with 1 when any is, or when an indication is not answered.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <mdclog/mdclog.h>
+#include <rmr/rmr.h>
+#include <rmr/RIC_message_types.h>
+
+#include "msgs_proc.hpp"
+#include "xapp_latency.hpp"
+#include "bench_msgs.hpp"
+#include "heap_count.hpp"
+
+#define ALLOC_CHECK_WARMUP_ROUNDS 100
+#define ALLOC_CHECK_ROUNDS 10000
+#define ALLOC_CHECK_PORT "4592"	// never listened to, rmr just needs one
+
+// Indications of every UEID shape and header format, with messages and call process ids of a few sizes
+static std::vector<std::vector<uint8_t>> make_indications(void) {
+	static const size_t message_sizes[] = {4, 100, 1000};
+	static const size_t call_process_id_sizes[] = {0, 4, INDICATION_CALL_PROCESS_ID_SIZE};
+	std::vector<std::vector<uint8_t>> indications;
+
+	for (int format = 0; format < BENCH_HEADER_FORMATS; format++) {
+		for (int shape = 0; shape < BENCH_UEID_SHAPES; shape++) {
+			unsigned int seed = format * BENCH_UEID_SHAPES + shape;
+			std::vector<uint8_t> header;
+			std::vector<uint8_t> msg = bench_bytes(message_sizes[seed % 3], seed);
+			std::vector<uint8_t> call_process_id = bench_bytes(call_process_id_sizes[(seed / 3) % 3], seed);
+			ric_indication_helper helper;
+			std::string error;
+
+			if (!bench_encode_indication_header(format, shape, seed, header)) {
+				fprintf(stderr, "unable to encode indication header format %d, UEID shape %d\n", format, shape);
+				exit(1);
+			}
+			bench_fill_indication(helper, header, msg, call_process_id);
+			indications.emplace_back();
+			if (!bench_encode_indication(helper, indications.back(), error)) {
+				fprintf(stderr, "unable to encode indication: %s\n", error.c_str());
+				exit(1);
+			}
+		}
+	}
+	return indications;
+}
+
+// Runs the indications through the handler for the given number of rounds, returns false when one is not answered
+static bool handle_indications(XappMsgHandler &handler, rmr_mbuf_t *mbuf, const std::vector<std::vector<uint8_t>> &indications, int rounds) {
+	for (int round = 0; round < rounds; round++) {
+		for (const std::vector<uint8_t> &ind : indications) {
+			latency_stamps stamps;
+			bool resend = false;
+
+			memcpy(mbuf->payload, ind.data(), ind.size());
+			mbuf->len = ind.size();
+			mbuf->mtype = RIC_INDICATION;
+			mbuf->sub_id = -1;
+			stamps.received = latency_clock();
+			handler(mbuf, &resend, &stamps);
+			if (!resend || mbuf->mtype != RIC_CONTROL_REQ) {
+				return false;
+			}
+			stamps.record_sent();
+		}
+	}
+	return true;
+}
+
+int main(int argc, char **argv) {
+	const char *port = argc > 1 ? argv[1] : ALLOC_CHECK_PORT;
+	int failed = 0;
+
+	mdclog_level_set(MDCLOG_ERR);	// the xapp takes the IndicationView path up to INFO
+
+	std::vector<std::vector<uint8_t>> indications = make_indications();
+	size_t max_size = 0;
+	for (const std::vector<uint8_t> &ind : indications) {
+		max_size = std::max(max_size, ind.size());
+	}
+
+	void *rmr_ctx = rmr_init(const_cast<char *>(port), RMR_MAX_RCV_BYTES, RMRFL_NONE);
+	if (rmr_ctx == NULL) {
+		fprintf(stderr, "unable to initialize RMR on port %s\n", port);
+		return 1;
+	}
+
+	for (int fast = 0; fast <= 1; fast++) {
+		const char *encoder = fast ? "fast" : "asn1c";
+		XappMsgHandler handler("alloc_check");
+		handler.set_fast_control_encoder(fast != 0);
+		rmr_mbuf_t *mbuf = rmr_alloc_msg(rmr_ctx, max_size);
+
+		if (!handle_indications(handler, mbuf, indications, ALLOC_CHECK_WARMUP_ROUNDS)) {
+			fprintf(stderr, "%s encoder: an indication was not answered\n", encoder);
+			failed = 1;
+			rmr_free_msg(mbuf);
+			continue;
+		}
+
+		size_t allocs = heap_allocs;
+		size_t bytes = heap_bytes;
+		bool answered = handle_indications(handler, mbuf, indications, ALLOC_CHECK_ROUNDS);
+		allocs = heap_allocs - allocs;
+		bytes = heap_bytes - bytes;
+
+		size_t handled = ALLOC_CHECK_ROUNDS * indications.size();
+		printf("%s encoder: %zu indications, %zu heap allocations, %zu bytes\n", encoder, handled, allocs, bytes);
+		if (!answered) {
+			fprintf(stderr, "%s encoder: an indication was not answered\n", encoder);
+			failed = 1;
+		}
+		if (allocs != 0) {
+			failed = 1;
+		}
+		rmr_free_msg(mbuf);
+	}
+
+	rmr_close(rmr_ctx);
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+	return failed;
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2005-2017 Lev Walkin <vlm@lionet.info>.
+ * All rights reserved.
+ * Redistribution and modifications are permitted subject to BSD license.
+ */
+/*
+ * asn_bit_data_ref.h
+ *
+ * The original asn1c PER bit I/O, see asn_bit_data_ref.c.
+ */
+#ifndef	ASN_BIT_DATA_REF_H
+#define	ASN_BIT_DATA_REF_H
+
+#include <asn_bit_data.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int32_t asn_ref_get_few_bits(asn_bit_data_t *, int get_nbits);
+int asn_ref_get_many_bits(asn_bit_data_t *, uint8_t *dst, int right_align, int get_nbits);
+int asn_ref_put_few_bits(asn_bit_outp_t *, uint32_t bits, int obits);
+int asn_ref_put_many_bits(asn_bit_outp_t *, const uint8_t *src, int put_nbits);
+int asn_ref_put_aligned_flush(asn_bit_outp_t *);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* ASN_BIT_DATA_REF_H */
@@ -0,0 +1,166 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+/*
+ * bench_msgs.cc
+ *
+ * Builders of the E2AP and E2SM-RC messages used by the benchmarks and the differential tests.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_msgs.hpp"
+
+extern "C" {
+	#include "E2SM-RC-IndicationHeader-Format2.h"
+	#include "E2SM-RC-IndicationHeader-Format3.h"
+	#include "UEID-GNB.h"
+	#include "UEID-GNB-DU.h"
+}
+
+void bench_set_bits(BIT_STRING_t *bits, unsigned int value, int nbits) {
+	int size = (nbits + 7) / 8;
+
+	bits->buf = (uint8_t *) calloc(1, size);
+	bits->size = size;
+	bits->bits_unused = size * 8 - nbits;
+	value <<= bits->bits_unused;
+	for (int i = size - 1; i >= 0; i--, value >>= 8) {
+		bits->buf[i] = value & 0xff;
+	}
+}
+
+UEID_t *bench_make_ueid(int shape, unsigned int seed) {
+	static const uint8_t plmnid[] = {0x00, 0xf1, 0x10};
+	UEID_t *ueid = (UEID_t *) calloc(1, sizeof(UEID_t));
+
+	if (shape == BENCH_UEID_GNB_DU) {
+		UEID_GNB_DU_t *du = (UEID_GNB_DU_t *) calloc(1, sizeof(UEID_GNB_DU_t));
+		ueid->present = UEID_PR_gNB_DU_UEID;
+		ueid->choice.gNB_DU_UEID = du;
+		du->gNB_CU_UE_F1AP_ID = 7919UL * seed + 1;
+		return ueid;
+	}
+
+	UEID_GNB_t *gnb = (UEID_GNB_t *) calloc(1, sizeof(UEID_GNB_t));
+	ueid->present = UEID_PR_gNB_UEID;
+	ueid->choice.gNB_UEID = gnb;
+	if (shape == BENCH_UEID_GNB_LONG_AMF) {
+		asn_ulong2INTEGER(&gnb->amf_UE_NGAP_ID, 1099511627775UL - seed);	// top of the 40 bit range
+	} else {
+		asn_ulong2INTEGER(&gnb->amf_UE_NGAP_ID, 1 + seed % 255);
+	}
+	OCTET_STRING_fromBuf(&gnb->guami.pLMNIdentity, (const char *) plmnid, sizeof(plmnid));
+	bench_set_bits(&gnb->guami.aMFRegionID, 128 + seed % 128, 8);
+	bench_set_bits(&gnb->guami.aMFSetID, 4 + seed % 1020, 10);
+	bench_set_bits(&gnb->guami.aMFPointer, 1 + seed % 63, 6);
+	if (shape == BENCH_UEID_GNB_RAN) {
+		std::vector<uint8_t> ran_ueid = bench_bytes(8, seed);
+		gnb->ran_UEID = OCTET_STRING_new_fromBuf(&asn_DEF_RANUEID, (const char *) ran_ueid.data(), ran_ueid.size());
+	}
+
+	return ueid;
+}
+
+E2SM_RC_IndicationHeader_t *bench_make_indication_header(int format, int shape, unsigned int seed) {
+	return bench_make_indication_header(format, bench_make_ueid(shape, seed), seed);
+}
+
+E2SM_RC_IndicationHeader_t *bench_make_indication_header(int format, UEID_t *ueid, unsigned int seed) {
+	E2SM_RC_IndicationHeader_t *header = (E2SM_RC_IndicationHeader_t *) calloc(1, sizeof(E2SM_RC_IndicationHeader_t));
+
+	if (format == BENCH_HEADER_FORMAT2) {
+		E2SM_RC_IndicationHeader_Format2_t *format2 = (E2SM_RC_IndicationHeader_Format2_t *) calloc(1, sizeof(E2SM_RC_IndicationHeader_Format2_t));
+		header->ric_indicationHeader_formats.present = E2SM_RC_IndicationHeader__ric_indicationHeader_formats_PR_indicationHeader_Format2;
+		header->ric_indicationHeader_formats.choice.indicationHeader_Format2 = format2;
+		format2->ueID = *ueid;	// Format2 holds the UEID itself
+		free(ueid);
+		format2->ric_InsertStyle_Type = 2;
+		format2->ric_InsertIndication_ID = 1 + seed % 65535;
+		return header;
+	}
+
+	E2SM_RC_IndicationHeader_Format3_t *format3 = (E2SM_RC_IndicationHeader_Format3_t *) calloc(1, sizeof(E2SM_RC_IndicationHeader_Format3_t));
+	header->ric_indicationHeader_formats.present = E2SM_RC_IndicationHeader__ric_indicationHeader_formats_PR_indicationHeader_Format3;
+	header->ric_indicationHeader_formats.choice.indicationHeader_Format3 = format3;
+	format3->ueID = ueid;
+	if (format == BENCH_HEADER_FORMAT3_TRIGGER || format == BENCH_HEADER_FORMAT3_EXT_TRIGGER) {
+		format3->ric_eventTriggerCondition_ID = (RIC_EventTriggerCondition_ID_t *) calloc(1, sizeof(RIC_EventTriggerCondition_ID_t));
+		*format3->ric_eventTriggerCondition_ID = format == BENCH_HEADER_FORMAT3_TRIGGER ? 1 + seed % 65535 : 65536 + 13 * seed;
+	}
+
+	return header;
+}
+
+std::vector<uint8_t> bench_bytes(size_t size, unsigned int seed) {
+	std::vector<uint8_t> bytes(size);
+
+	for (size_t i = 0; i < size; i++) {
+		bytes[i] = (uint8_t) (seed * 31 + i * 7);
+	}
+	return bytes;
+}
+
+bool bench_encode(const asn_TYPE_descriptor_t *type, const void *sptr, std::vector<uint8_t> &out) {
+	uint8_t buf[BENCH_BUFFER_SIZE];
+
+	asn_enc_rval_t retval = asn_encode_to_buffer(0, ATS_ALIGNED_BASIC_PER, type, sptr, buf, sizeof(buf));
+	if (retval.encoded < 0 || retval.encoded > (ssize_t) sizeof(buf)) {
+		return false;
+	}
+	out.assign(buf, buf + retval.encoded);
+	return true;
+}
+
+bool bench_encode_indication_header(int format, int shape, unsigned int seed, std::vector<uint8_t> &out) {
+	E2SM_RC_IndicationHeader_t *header = bench_make_indication_header(format, shape, seed);
+
+	bool res = bench_encode(&asn_DEF_E2SM_RC_IndicationHeader, header, out);
+	ASN_STRUCT_FREE(asn_DEF_E2SM_RC_IndicationHeader, header);
+	return res;
+}
+
+void bench_fill_indication(ric_indication_helper &helper, const std::vector<uint8_t> &header,
+		const std::vector<uint8_t> &msg, const std::vector<uint8_t> &call_process_id) {
+	helper.request_id.ricRequestorID = BENCH_REQUESTOR_ID;
+	helper.request_id.ricInstanceID = BENCH_INSTANCE_ID;
+	helper.func_id = BENCH_FUNCTION_ID;
+	helper.action_id = 1;
+	helper.indication_sn = 5;
+	helper.indication_type = RICindicationType_insert;
+	helper.indication_header.buf = (uint8_t *) header.data();
+	helper.indication_header.size = header.size();
+	helper.indication_msg.buf = (uint8_t *) msg.data();
+	helper.indication_msg.size = msg.size();
+	helper.call_process_id.buf = (uint8_t *) call_process_id.data();
+	helper.call_process_id.size = call_process_id.size();
+}
+
+bool bench_encode_indication(ric_indication_helper &helper, std::vector<uint8_t> &out, std::string &error) {
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	ssize_t size = sizeof(buf);
+	ric_indication ind;
+
+	if (!ind.encode_e2ap_indication(buf, &size, helper)) {
+		error = ind.get_error();
+		return false;
+	}
+	out.assign(buf, buf + size);
+	return true;
+}
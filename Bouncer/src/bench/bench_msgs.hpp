@@ -0,0 +1,85 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+/*
+ * bench_msgs.hpp
+ *
+ * Builders of the E2AP and E2SM-RC messages used by the benchmarks and the differential tests.
+ * The UEID shapes and indication header formats are the ones E2 nodes send to the xapp.
+ */
+
+#pragma once
+
+#ifndef BENCH_BENCH_MSGS_HPP_
+#define BENCH_BENCH_MSGS_HPP_
+
+#include <string>
+#include <vector>
+
+#include "e2ap_indication.hpp"
+
+extern "C" {
+	#include "E2SM-RC-IndicationHeader.h"
+	#include "UEID.h"
+}
+
+#define BENCH_BUFFER_SIZE 65536
+
+static const long BENCH_REQUESTOR_ID = 1001;
+static const long BENCH_INSTANCE_ID = 7;
+static const long BENCH_FUNCTION_ID = 3;
+
+// UEIDs carried by indication headers
+enum bench_ueid_shape {
+	BENCH_UEID_GNB,			// gNB UEID with a one octet AMF UE NGAP ID
+	BENCH_UEID_GNB_RAN,		// gNB UEID with the optional RAN UEID
+	BENCH_UEID_GNB_LONG_AMF,	// gNB UEID with a five octet AMF UE NGAP ID
+	BENCH_UEID_GNB_DU,		// gNB-DU UEID
+	BENCH_UEID_SHAPES
+};
+
+// Formats of the E2SM-RC indication header
+enum bench_header_format {
+	BENCH_HEADER_FORMAT2,
+	BENCH_HEADER_FORMAT3,			// without event trigger condition ID
+	BENCH_HEADER_FORMAT3_TRIGGER,		// event trigger condition ID within its root range
+	BENCH_HEADER_FORMAT3_EXT_TRIGGER,	// event trigger condition ID in the extension range
+	BENCH_HEADER_FORMATS
+};
+
+void bench_set_bits(BIT_STRING_t *bits, unsigned int value, int nbits);
+
+// The seed varies the field values within the shape, free the UEID with ASN_STRUCT_FREE(asn_DEF_UEID, ...)
+UEID_t *bench_make_ueid(int shape, unsigned int seed);
+E2SM_RC_IndicationHeader_t *bench_make_indication_header(int format, int shape, unsigned int seed);
+// The header takes over the UEID
+E2SM_RC_IndicationHeader_t *bench_make_indication_header(int format, UEID_t *ueid, unsigned int seed);
+
+// Deterministic filler bytes for octet strings
+std::vector<uint8_t> bench_bytes(size_t size, unsigned int seed);
+
+// Aligned PER encoding of any asn1c structure, returns false when it does not encode
+bool bench_encode(const asn_TYPE_descriptor_t *type, const void *sptr, std::vector<uint8_t> &out);
+bool bench_encode_indication_header(int format, int shape, unsigned int seed, std::vector<uint8_t> &out);
+
+// The helper points into the given vectors, which must outlive it
+void bench_fill_indication(ric_indication_helper &helper, const std::vector<uint8_t> &header,
+		const std::vector<uint8_t> &msg, const std::vector<uint8_t> &call_process_id);
+bool bench_encode_indication(ric_indication_helper &helper, std::vector<uint8_t> &out, std::string &error);
+
+#endif /* BENCH_BENCH_MSGS_HPP_ */
@@ -0,0 +1,811 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+/*
+ * codec_bench.cc
+ *
+ * Microbenchmarks of the E2AP and E2SM encoders/decoders in xapp-asn, run with "make bench".
+ *
+ * Every message type is encoded in a few shapes and sizes from fixed field values, and the
+ * resulting bytes form the corpus the decoders run over, so two builds always measure the
+ * same messages. Each benchmark cycles through all the variants of its message type.
+ * Besides ns/op, each benchmark reports:
+ *   allocs/op  heap allocations (malloc, calloc and realloc) per encoded or decoded message
+ *   bytes/op   heap bytes requested per message
+ * and the message sizes are reported as throughput (bytes_per_second).
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <mdclog/mdclog.h>
+
+#include "subscription_request.hpp"
+#include "subscription_response.hpp"
+#include "subscription_delete_request.hpp"
+#include "subscription_delete_response.hpp"
+#include "e2ap_indication.hpp"
+#include "e2ap_indication_view.hpp"
+#include "e2ap_control.hpp"
+#include "e2ap_control_response.hpp"
+#include "e2sm_control.hpp"
+#include "e2sm_control_cache.hpp"
+#include "e2sm_ueid.hpp"
+#include "bench_msgs.hpp"
+#include "heap_count.hpp"
+
+extern "C" {
+	#include "E2AP-PDU.h"
+	#include "E2SM-RC-ControlHeader.h"
+	#include "E2SM-RC-ControlMessage.h"
+}
+
+// Heap allocations of a benchmark, see heap_count.cc
+struct heap_counter {
+	heap_counter(): allocs(heap_allocs), bytes(heap_bytes) {};
+
+	// sets the per message counters of the benchmark, msg_bytes is the size of all the messages it went through
+	void report(benchmark::State &state, size_t msg_bytes) const {
+		state.counters["allocs/op"] = benchmark::Counter(heap_allocs - allocs, benchmark::Counter::kAvgIterations);
+		state.counters["bytes/op"] = benchmark::Counter(heap_bytes - bytes, benchmark::Counter::kAvgIterations);
+		state.SetBytesProcessed(msg_bytes);
+	};
+
+	size_t allocs;
+	size_t bytes;
+};
+
+/*
+	Shapes and sizes of the corpus messages, the benchmarks cycle through them.
+	Variant i of a message type picks entry i modulo the table size of every table below.
+*/
+#define SUBSCRIPTION_VARIANTS 3
+#define CONTROL_MESSAGE_VARIANTS 3
+
+static const int subscription_actions[] = {1, 4, 16};
+static const size_t event_trigger_sizes[] = {4, 32, 256};
+static const size_t action_definition_sizes[] = {6, 64, 512};
+static const int admitted_actions[] = {1, 4, 16};
+static const int not_admitted_actions[] = {0, 2, 8};
+static const size_t indication_message_sizes[] = {4, 100, 1000};
+static const size_t call_process_id_sizes[] = {4, 16, 64};	// 64 is the longest the xapp takes without the full decode
+static const unsigned long nr_cell_ids[] = {E2SM_RC_DEFAULT_NR_CELL_ID, 1, 68719476735UL};	// the last one is 36 bits
+
+#define VARIANT(table, i) ((table)[(i) % (sizeof(table) / sizeof((table)[0]))])
+
+// Octet string contents, no encoder looks at them
+static const std::vector<uint8_t> &filler(void) {
+	static const std::vector<uint8_t> bytes = bench_bytes(4096, 1);
+	return bytes;
+}
+
+static void fill_subscription(subscription_helper &helper, int variant) {
+	RICrequestID_t request_id = {BENCH_REQUESTOR_ID, BENCH_INSTANCE_ID};
+
+	helper.clear();
+	helper.set_request(request_id);
+	helper.set_function_id(BENCH_FUNCTION_ID);
+	helper.set_event_def(filler().data(), VARIANT(event_trigger_sizes, variant));
+	for (int i = 0; i < VARIANT(subscription_actions, variant); i++) {
+		if (i % 2 == 0) {
+			helper.add_action(i + 1, RICactionType_report, filler().data(), VARIANT(action_definition_sizes, variant), RICsubsequentActionType_continue);
+		} else {
+			helper.add_action(i + 1, RICactionType_insert);
+		}
+	}
+}
+
+static void fill_subscription_response(subscription_response_helper &helper, int variant) {
+	int admitted = VARIANT(admitted_actions, variant);
+
+	helper.clear();
+	helper.set_request(BENCH_REQUESTOR_ID, BENCH_INSTANCE_ID);
+	helper.set_function_id(BENCH_FUNCTION_ID);
+	for (int i = 0; i < admitted; i++) {
+		helper.add_action(i + 1);
+	}
+	for (int i = 0; i < VARIANT(not_admitted_actions, variant); i++) {
+		helper.add_action(admitted + i + 1, Cause_PR_ricRequest, CauseRICrequest_action_not_supported);
+	}
+}
+
+static void fill_control(ric_control_helper &helper, int variant, uint8_t *header, size_t header_size, uint8_t *msg, size_t msg_size) {
+	helper.requestor_id = BENCH_REQUESTOR_ID;
+	helper.instance_id = BENCH_INSTANCE_ID;
+	helper.func_id = BENCH_FUNCTION_ID;
+	helper.call_process_id = (uint8_t *) filler().data();
+	helper.call_process_id_size = VARIANT(call_process_id_sizes, variant);
+	helper.control_ack = RICcontrolAckRequest_noAck;
+	helper.control_header = header;
+	helper.control_header_size = header_size;
+	helper.control_msg = msg;
+	helper.control_msg_size = msg_size;
+}
+
+/*
+	Encoded messages the decoders run over, built once from the tables above.
+	The indication headers cover every UEID shape in every header format.
+*/
+typedef std::vector<std::vector<uint8_t>> bench_msg_list;
+
+struct bench_corpus {
+	bench_corpus(void);
+
+	bench_msg_list sub_request;
+	bench_msg_list sub_response;
+	bench_msg_list sub_delete_request;
+	bench_msg_list sub_delete_response;
+	bench_msg_list indication_header;
+	bench_msg_list indication;
+	bench_msg_list rc_control_header;	// one per UEID shape
+	bench_msg_list rc_control_message;
+	bench_msg_list control_request;		// one per UEID shape
+	bench_msg_list control_response;
+
+	// indication i carries indication_header[i], its message and call process id are kept here
+	bench_msg_list indication_message;
+	bench_msg_list indication_call_process_id;
+};
+
+static void corpus_failed(const char *what, const std::string &error) {
+	fprintf(stderr, "unable to build the %s of the benchmark corpus: %s\n", what, error.c_str());
+	exit(1);
+}
+
+bench_corpus::bench_corpus(void) {
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	ssize_t size;
+
+	for (int variant = 0; variant < SUBSCRIPTION_VARIANTS; variant++) {
+		subscription_helper helper;
+		subscription_request req;
+		fill_subscription(helper, variant);
+		size = sizeof(buf);
+		if (!req.encode_e2ap_subscription(buf, &size, helper))
+			corpus_failed("subscription request", req.get_error());
+		sub_request.emplace_back(buf, buf + size);
+
+		subscription_delete delete_req;
+		size = sizeof(buf);
+		if (!delete_req.encode_e2ap_subscription(buf, &size, helper))
+			corpus_failed("subscription delete request", delete_req.get_error());
+		sub_delete_request.emplace_back(buf, buf + size);
+	}
+	for (int variant = 0; variant < SUBSCRIPTION_VARIANTS; variant++) {
+		subscription_response_helper helper;
+		subscription_response resp;
+		fill_subscription_response(helper, variant);
+		size = sizeof(buf);
+		if (!resp.encode_e2ap_subscription_response_success(buf, &size, helper))
+			corpus_failed("subscription response", resp.get_error());
+		sub_response.emplace_back(buf, buf + size);
+
+		subscription_delete_response delete_resp;
+		size = sizeof(buf);
+		if (!delete_resp.encode_e2ap_subscription_delete_response(buf, &size, helper, true))
+			corpus_failed("subscription delete response", delete_resp.get_error_string());
+		sub_delete_response.emplace_back(buf, buf + size);
+	}
+	for (int format = 0; format < BENCH_HEADER_FORMATS; format++) {
+		for (int shape = 0; shape < BENCH_UEID_SHAPES; shape++) {
+			std::vector<uint8_t> header;
+			if (!bench_encode_indication_header(format, shape, format * BENCH_UEID_SHAPES + shape, header))
+				corpus_failed("indication header", "");
+			indication_header.push_back(header);
+		}
+	}
+	for (size_t i = 0; i < indication_header.size(); i++) {
+		ric_indication_helper helper;
+		std::string error;
+		indication_message.push_back(bench_bytes(VARIANT(indication_message_sizes, i), i));
+		indication_call_process_id.push_back(bench_bytes(VARIANT(call_process_id_sizes, i / 3), i));
+		bench_fill_indication(helper, indication_header[i], indication_message[i], indication_call_process_id[i]);
+		indication.emplace_back();
+		if (!bench_encode_indication(helper, indication.back(), error))
+			corpus_failed("indication", error);
+	}
+	{
+		e2sm_control e2sm;
+		for (int shape = 0; shape < BENCH_UEID_SHAPES; shape++) {
+			UEID_t *ueid = bench_make_ueid(shape, shape);
+			size = sizeof(buf);
+			if (!e2sm.encode_rc_control_header(buf, &size, ueid))
+				corpus_failed("RC control header", e2sm.get_error());
+			rc_control_header.emplace_back(buf, buf + size);
+			ASN_STRUCT_FREE(asn_DEF_UEID, ueid);
+		}
+		for (int variant = 0; variant < CONTROL_MESSAGE_VARIANTS; variant++) {
+			size = sizeof(buf);
+			if (!e2sm.encode_rc_control_message(buf, &size, E2SM_RC_DEFAULT_PLMN, VARIANT(nr_cell_ids, variant)))
+				corpus_failed("RC control message", e2sm.get_error());
+			rc_control_message.emplace_back(buf, buf + size);
+		}
+	}
+	for (size_t i = 0; i < rc_control_header.size(); i++) {
+		ric_control_helper helper;
+		ric_control_request req;
+		std::vector<uint8_t> &control_msg = rc_control_message[i % rc_control_message.size()];
+		fill_control(helper, i, rc_control_header[i].data(), rc_control_header[i].size(), control_msg.data(), control_msg.size());
+		size = sizeof(buf);
+		if (!req.encode_e2ap_control_request(buf, &size, helper))
+			corpus_failed("control request", req.get_error());
+		control_request.emplace_back(buf, buf + size);
+	}
+	for (size_t i = 0; i < sizeof(call_process_id_sizes) / sizeof(call_process_id_sizes[0]); i++) {
+		ric_control_helper helper;
+		ric_control_response resp;
+		fill_control(helper, i, NULL, 0, NULL, 0);
+		size = sizeof(buf);
+		if (!resp.encode_e2ap_control_response(buf, &size, helper, true))
+			corpus_failed("control response", resp.get_error());
+		control_response.emplace_back(buf, buf + size);
+	}
+}
+
+static const bench_corpus &corpus(void) {
+	static bench_corpus instance;
+	return instance;
+}
+
+// Cycles through the messages of a list, adding up their sizes for the throughput
+struct msg_cycle {
+	msg_cycle(const bench_msg_list &list): msgs(list), next(0), bytes(0) {};
+
+	const std::vector<uint8_t> &get(void) {
+		const std::vector<uint8_t> &msg = msgs[next];
+		if (++next == msgs.size())
+			next = 0;
+		bytes += msg.size();
+		return msg;
+	};
+
+	const bench_msg_list &msgs;
+	size_t next;
+	size_t bytes;
+};
+
+// Decodes an E2AP PDU of the corpus the same way the xapp does, before its fields are read
+static E2AP_PDU_t *decode_pdu(benchmark::State &state, const std::vector<uint8_t> &msg) {
+	E2AP_PDU_t *pdu = NULL;
+	asn_dec_rval_t rval = asn_decode(0, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2AP_PDU, (void **) &pdu, msg.data(), msg.size());
+	if (rval.code != RC_OK) {
+		state.SkipWithError("unable to decode the E2AP PDU");
+	}
+	return pdu;
+}
+
+/*
+	E2AP subscription request
+*/
+static void BM_SubscriptionRequestEncode(benchmark::State &state) {
+	subscription_helper helpers[SUBSCRIPTION_VARIANTS];
+	subscription_request req;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	int variant = 0;
+
+	for (int i = 0; i < SUBSCRIPTION_VARIANTS; i++)
+		fill_subscription(helpers[i], i);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!req.encode_e2ap_subscription(buf, &size, helpers[variant])) {
+			state.SkipWithError(req.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % SUBSCRIPTION_VARIANTS;
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_SubscriptionRequestEncode);
+
+static void BM_SubscriptionRequestDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().sub_request);
+	subscription_request req;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		subscription_helper helper;
+		E2AP_PDU_t *pdu = decode_pdu(state, msgs.get());
+		if (pdu == NULL)
+			break;
+		req.get_fields(pdu->choice.initiatingMessage, helper);
+		benchmark::DoNotOptimize(helper);
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, pdu);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_SubscriptionRequestDecode);
+
+/*
+	E2AP subscription response
+*/
+static void BM_SubscriptionResponseEncode(benchmark::State &state) {
+	subscription_response_helper helpers[SUBSCRIPTION_VARIANTS];
+	subscription_response resp;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	int variant = 0;
+
+	for (int i = 0; i < SUBSCRIPTION_VARIANTS; i++)
+		fill_subscription_response(helpers[i], i);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!resp.encode_e2ap_subscription_response_success(buf, &size, helpers[variant])) {
+			state.SkipWithError(resp.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % SUBSCRIPTION_VARIANTS;
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_SubscriptionResponseEncode);
+
+static void BM_SubscriptionResponseDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().sub_response);
+	subscription_response resp;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		subscription_response_helper helper;
+		E2AP_PDU_t *pdu = decode_pdu(state, msgs.get());
+		if (pdu == NULL)
+			break;
+		resp.get_fields(pdu->choice.successfulOutcome, helper);
+		benchmark::DoNotOptimize(helper);
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, pdu);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_SubscriptionResponseDecode);
+
+/*
+	E2AP subscription delete request and response
+*/
+static void BM_SubscriptionDeleteRequestEncode(benchmark::State &state) {
+	subscription_helper helpers[SUBSCRIPTION_VARIANTS];
+	subscription_delete req;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	int variant = 0;
+
+	for (int i = 0; i < SUBSCRIPTION_VARIANTS; i++)
+		fill_subscription(helpers[i], i);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!req.encode_e2ap_subscription(buf, &size, helpers[variant])) {
+			state.SkipWithError(req.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % SUBSCRIPTION_VARIANTS;
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_SubscriptionDeleteRequestEncode);
+
+static void BM_SubscriptionDeleteRequestDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().sub_delete_request);
+	subscription_delete req;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		subscription_helper helper;
+		E2AP_PDU_t *pdu = decode_pdu(state, msgs.get());
+		if (pdu == NULL)
+			break;
+		req.get_fields(pdu->choice.initiatingMessage, helper);
+		benchmark::DoNotOptimize(helper);
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, pdu);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_SubscriptionDeleteRequestDecode);
+
+static void BM_SubscriptionDeleteResponseEncode(benchmark::State &state) {
+	subscription_response_helper helpers[SUBSCRIPTION_VARIANTS];
+	subscription_delete_response resp;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	int variant = 0;
+
+	for (int i = 0; i < SUBSCRIPTION_VARIANTS; i++)
+		fill_subscription_response(helpers[i], i);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!resp.encode_e2ap_subscription_delete_response(buf, &size, helpers[variant], true)) {
+			state.SkipWithError(resp.get_error_string().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % SUBSCRIPTION_VARIANTS;
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_SubscriptionDeleteResponseEncode);
+
+static void BM_SubscriptionDeleteResponseDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().sub_delete_response);
+	subscription_delete_response resp;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		subscription_response_helper helper;
+		E2AP_PDU_t *pdu = decode_pdu(state, msgs.get());
+		if (pdu == NULL)
+			break;
+		resp.get_fields(pdu->choice.successfulOutcome, helper);
+		benchmark::DoNotOptimize(helper);
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, pdu);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_SubscriptionDeleteResponseDecode);
+
+/*
+	E2AP indication, decoded by asn1c or through IndicationView, and the UEID of its E2SM-RC header
+*/
+static void BM_IndicationEncode(benchmark::State &state) {
+	const bench_corpus &msgs = corpus();
+	std::vector<ric_indication_helper> helpers(msgs.indication.size());
+	ric_indication ind;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	size_t variant = 0;
+
+	for (size_t i = 0; i < helpers.size(); i++)
+		bench_fill_indication(helpers[i], msgs.indication_header[i], msgs.indication_message[i], msgs.indication_call_process_id[i]);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!ind.encode_e2ap_indication(buf, &size, helpers[variant])) {
+			state.SkipWithError(ind.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % helpers.size();
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_IndicationEncode);
+
+static void BM_IndicationDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().indication);
+	ric_indication ind;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ric_indication_helper helper;
+		E2AP_PDU_t *pdu = decode_pdu(state, msgs.get());
+		if (pdu == NULL)
+			break;
+		ind.get_fields(pdu->choice.initiatingMessage, helper);
+		benchmark::DoNotOptimize(helper);
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, pdu);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_IndicationDecode);
+
+static void BM_IndicationViewDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().indication);
+	IndicationView view;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ric_indication_helper helper;
+		const std::vector<uint8_t> &msg = msgs.get();
+		if (!view.parse(msg.data(), msg.size()) || !view.get_fields(helper)) {
+			state.SkipWithError(view.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(helper);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_IndicationViewDecode);
+
+static void BM_IndicationUeidDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().indication_header);
+	e2sm_rc_ueid_decoder decoder;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		e2sm_rc_ueid_ref ue;
+		const std::vector<uint8_t> &msg = msgs.get();
+		if (!decoder.decode(msg.data(), msg.size(), ue)) {
+			state.SkipWithError(decoder.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(ue);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_IndicationUeidDecode);
+
+/*
+	E2SM-RC control header and message
+*/
+static void BM_RCControlHeaderEncode(benchmark::State &state) {
+	UEID_t *ueids[BENCH_UEID_SHAPES];
+	e2sm_control e2sm;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	int shape = 0;
+
+	for (int i = 0; i < BENCH_UEID_SHAPES; i++)
+		ueids[i] = bench_make_ueid(i, i);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!e2sm.encode_rc_control_header(buf, &size, ueids[shape])) {
+			state.SkipWithError(e2sm.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		shape = (shape + 1) % BENCH_UEID_SHAPES;
+	}
+	heap.report(state, bytes);
+
+	for (int i = 0; i < BENCH_UEID_SHAPES; i++)
+		ASN_STRUCT_FREE(asn_DEF_UEID, ueids[i]);
+}
+BENCHMARK(BM_RCControlHeaderEncode);
+
+// The header of the control request for an indication, spliced from the UEID bits of its header
+static void BM_RCControlHeaderSplice(benchmark::State &state) {
+	const bench_msg_list &headers = corpus().indication_header;
+	std::vector<e2sm_rc_ueid_ref> ues(headers.size());
+	e2sm_rc_ueid_decoder decoder;
+	e2sm_control e2sm;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	size_t variant = 0;
+
+	for (size_t i = 0; i < headers.size(); i++) {
+		if (!decoder.decode(headers[i].data(), headers[i].size(), ues[i])) {
+			state.SkipWithError(decoder.get_error().c_str());
+			return;
+		}
+	}
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!e2sm.encode_rc_control_header(buf, &size, ues[variant], NULL)) {
+			state.SkipWithError(e2sm.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % ues.size();
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_RCControlHeaderSplice);
+
+static void BM_RCControlHeaderDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().rc_control_header);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		E2SM_RC_ControlHeader_t *header = NULL;
+		const std::vector<uint8_t> &msg = msgs.get();
+		asn_dec_rval_t rval = asn_decode(0, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2SM_RC_ControlHeader, (void **) &header, msg.data(), msg.size());
+		if (rval.code != RC_OK) {
+			state.SkipWithError("unable to decode the RC control header");
+			break;
+		}
+		benchmark::DoNotOptimize(header);
+		ASN_STRUCT_FREE(asn_DEF_E2SM_RC_ControlHeader, header);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_RCControlHeaderDecode);
+
+static void BM_RCControlMessageEncode(benchmark::State &state) {
+	e2sm_control e2sm;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	int variant = 0;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!e2sm.encode_rc_control_message(buf, &size, E2SM_RC_DEFAULT_PLMN, VARIANT(nr_cell_ids, variant))) {
+			state.SkipWithError(e2sm.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % CONTROL_MESSAGE_VARIANTS;
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_RCControlMessageEncode);
+
+// Every (cell, decision) pair is cached after the first round
+static void BM_RCControlMessageCached(benchmark::State &state) {
+	static const long decisions[] = {E2SM_RC_ControlHeader_Format1__ric_ControlDecision_accept, E2SM_RC_ControlHeader_Format1__ric_ControlDecision_reject};
+	e2sm_control_cache cache;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	int variant = 0;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!cache.get_control_message(buf, &size, E2SM_RC_DEFAULT_PLMN, VARIANT(nr_cell_ids, variant), VARIANT(decisions, variant / CONTROL_MESSAGE_VARIANTS))) {
+			state.SkipWithError(cache.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % (2 * CONTROL_MESSAGE_VARIANTS);
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_RCControlMessageCached);
+
+static void BM_RCControlMessageDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().rc_control_message);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		E2SM_RC_ControlMessage_t *control_msg = NULL;
+		const std::vector<uint8_t> &msg = msgs.get();
+		asn_dec_rval_t rval = asn_decode(0, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2SM_RC_ControlMessage, (void **) &control_msg, msg.data(), msg.size());
+		if (rval.code != RC_OK) {
+			state.SkipWithError("unable to decode the RC control message");
+			break;
+		}
+		benchmark::DoNotOptimize(control_msg);
+		ASN_STRUCT_FREE(asn_DEF_E2SM_RC_ControlMessage, control_msg);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_RCControlMessageDecode);
+
+/*
+	E2AP control request, range(0) selects the asn1c (0) or the hand-written (1) encoder,
+	and the control response
+*/
+static void BM_ControlRequestEncode(benchmark::State &state) {
+	const bench_corpus &msgs = corpus();
+	std::vector<ric_control_helper> helpers(msgs.rc_control_header.size());
+	ric_control_request req;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	size_t variant = 0;
+
+	for (size_t i = 0; i < helpers.size(); i++) {
+		const std::vector<uint8_t> &control_msg = msgs.rc_control_message[i % msgs.rc_control_message.size()];
+		fill_control(helpers[i], i, (uint8_t *) msgs.rc_control_header[i].data(), msgs.rc_control_header[i].size(),
+				(uint8_t *) control_msg.data(), control_msg.size());
+	}
+	req.set_fast_encoding(state.range(0) != 0);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!req.encode_e2ap_control_request(buf, &size, helpers[variant])) {
+			state.SkipWithError(req.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % helpers.size();
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_ControlRequestEncode)->Arg(0)->Arg(1);
+
+static void BM_ControlRequestDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().control_request);
+	ric_control_request req;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ric_control_helper helper;
+		E2AP_PDU_t *pdu = decode_pdu(state, msgs.get());
+		if (pdu == NULL)
+			break;
+		req.get_fields(pdu->choice.initiatingMessage, helper);
+		benchmark::DoNotOptimize(helper);
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, pdu);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_ControlRequestDecode);
+
+static void BM_ControlResponseEncode(benchmark::State &state) {
+	const int variants = sizeof(call_process_id_sizes) / sizeof(call_process_id_sizes[0]);
+	ric_control_helper helpers[variants];
+	ric_control_response resp;
+	uint8_t buf[BENCH_BUFFER_SIZE];
+	size_t bytes = 0;
+	int variant = 0;
+
+	for (int i = 0; i < variants; i++)
+		fill_control(helpers[i], i, NULL, 0, NULL, 0);
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ssize_t size = sizeof(buf);
+		if (!resp.encode_e2ap_control_response(buf, &size, helpers[variant], true)) {
+			state.SkipWithError(resp.get_error().c_str());
+			break;
+		}
+		benchmark::DoNotOptimize(buf);
+		bytes += size;
+		variant = (variant + 1) % variants;
+	}
+	heap.report(state, bytes);
+}
+BENCHMARK(BM_ControlResponseEncode);
+
+static void BM_ControlResponseDecode(benchmark::State &state) {
+	msg_cycle msgs(corpus().control_response);
+	ric_control_response resp;
+
+	heap_counter heap;
+	for (auto _ : state) {
+		ric_control_helper helper;
+		E2AP_PDU_t *pdu = decode_pdu(state, msgs.get());
+		if (pdu == NULL)
+			break;
+		resp.get_fields(pdu->choice.successfulOutcome, helper);
+		benchmark::DoNotOptimize(helper);
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, pdu);
+	}
+	heap.report(state, msgs.bytes);
+}
+BENCHMARK(BM_ControlResponseDecode);
+
+int main(int argc, char **argv) {
+	mdclog_level_set(MDCLOG_ERR);	// some encoders log every message at INFO
+
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	corpus();	// built before any timing starts
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+
+	return 0;
+}
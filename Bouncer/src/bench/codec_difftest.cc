@@ -0,0 +1,751 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+
+/*
+ * codec_difftest.cc
+ *
+ * Differential tests of the hand-written codecs in xapp-asn against asn1c, and of the word at a time
+ * bit I/O in asn1c_defs against the original asn1c one, run with "make difftest".
+ *
+ * Every case is run through both implementations, which must agree byte for byte or field for
+ * field. Field values and lengths are picked at the edges of their constraints and of the APER
+ * length forms, and at random in between, from a fixed seed so that a failure can be reproduced. Exits with 1 on any
+ * mismatch, the first few of each test are printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <mdclog/mdclog.h>
+
+extern "C" {
+	#include "asn_random_fill.h"
+	#include "E2SM-RC-IndicationHeader-Format3.h"
+}
+
+#include "e2ap_control.hpp"
+#include "e2ap_indication_view.hpp"
+#include "e2sm_control.hpp"
+#include "e2sm_ueid.hpp"
+#include "bench_msgs.hpp"
+#include "asn_bit_data_ref.h"
+
+#define DIFFTEST_SEED 42
+#define DIFFTEST_RANDOM_CASES 200000
+#define DIFFTEST_MAX_REPORTS 10	// mismatches printed per test
+
+struct difftest_result {
+	difftest_result(const char *test_name): name(test_name), cases(0), mismatches(0) {};
+
+	// counts the case, and prints it when it is one of the first mismatches
+	void check(bool same, const std::string &what) {
+		cases++;
+		if (!same && ++mismatches <= DIFFTEST_MAX_REPORTS) {
+			fprintf(stderr, "%s mismatch: %s\n", name, what.c_str());
+		}
+	};
+
+	void report(void) const {
+		printf("%-24s %8lu cases, %lu mismatches\n", name, cases, mismatches);
+	};
+
+	const char *name;
+	unsigned long cases;
+	unsigned long mismatches;
+};
+
+/*
+	RIC control request, hand-written encoder against asn1c. Both must give the same bytes, or
+	both fail, and report the same required size when the buffer is too small.
+*/
+static const long control_ids[] = {0, 1, 127, 128, 255, 256, 65534, 65535};
+static const long control_func_ids[] = {0, 1, 127, 128, 255, 256, 4094, 4095};
+static const long control_acks[] = {-1, RICcontrolAckRequest_noAck, RICcontrolAckRequest_ack};
+// around the one and two octet APER lengths, of the octet strings and of the IE values holding them
+static const size_t control_sizes[] = {0, 1, 2, 63, 64, 65, 125, 126, 127, 128, 129, 130, 254, 255, 256, 1000, 8000};
+
+static std::string describe_control(const ric_control_helper &helper) {
+	char buf[256];
+	snprintf(buf, sizeof(buf), "requestor %ld instance %ld function %ld ack %ld header %zu message %zu call process id %zu",
+			helper.requestor_id, helper.instance_id, helper.func_id, helper.control_ack,
+			helper.control_header_size, helper.control_msg_size, helper.call_process_id_size);
+	return buf;
+}
+
+static void diff_control_request(difftest_result &result, ric_control_helper &helper) {
+	static std::vector<uint8_t> asn1c_buf(65536), fast_buf(65536);
+	ric_control_request asn1c_req, fast_req;
+	fast_req.set_fast_encoding(true);
+
+	ssize_t asn1c_size = asn1c_buf.size();
+	ssize_t fast_size = fast_buf.size();
+	bool asn1c_ok = asn1c_req.encode_e2ap_control_request(asn1c_buf.data(), &asn1c_size, helper);
+	bool fast_ok = fast_req.encode_e2ap_control_request(fast_buf.data(), &fast_size, helper);
+	bool same = asn1c_ok == fast_ok && (!asn1c_ok || (asn1c_size == fast_size && memcmp(asn1c_buf.data(), fast_buf.data(), asn1c_size) == 0));
+	result.check(same, describe_control(helper));
+	if (!same || !asn1c_ok) {
+		return;
+	}
+
+	// a buffer one octet short, and one of half the size
+	for (ssize_t short_size : {asn1c_size - 1, asn1c_size / 2}) {
+		ssize_t asn1c_required = short_size;
+		ssize_t fast_required = short_size;
+		asn1c_ok = asn1c_req.encode_e2ap_control_request(asn1c_buf.data(), &asn1c_required, helper);
+		fast_ok = fast_req.encode_e2ap_control_request(fast_buf.data(), &fast_required, helper);
+		result.check(!asn1c_ok && !fast_ok && asn1c_required == fast_required,
+				describe_control(helper) + " in a buffer of " + std::to_string(short_size));
+	}
+}
+
+static difftest_result difftest_control_request(std::mt19937 &rng) {
+	difftest_result result("control request");
+	std::vector<uint8_t> header = bench_bytes(16384, 1);
+	std::vector<uint8_t> msg = bench_bytes(16384, 2);
+	std::vector<uint8_t> call_process_id = bench_bytes(16384, 3);
+	const size_t num_sizes = sizeof(control_sizes) / sizeof(control_sizes[0]);
+	ric_control_helper helper;
+
+	helper.control_header = (uint8_t *) header.data();
+	helper.control_msg = (uint8_t *) msg.data();
+	helper.call_process_id = (uint8_t *) call_process_id.data();
+
+	// every id at the edges of its range, with and without ack request
+	for (long requestor_id : control_ids) {
+		for (long instance_id : control_ids) {
+			for (long func_id : control_func_ids) {
+				for (long control_ack : control_acks) {
+					helper.requestor_id = requestor_id;
+					helper.instance_id = instance_id;
+					helper.func_id = func_id;
+					helper.control_ack = control_ack;
+					helper.control_header_size = control_sizes[rng() % num_sizes];
+					helper.control_msg_size = control_sizes[rng() % num_sizes];
+					helper.call_process_id_size = control_sizes[rng() % num_sizes];
+					diff_control_request(result, helper);
+				}
+			}
+		}
+	}
+
+	// every combination of octet string lengths, a call process id of 0 leaves out the optional IE
+	for (size_t header_size : control_sizes) {
+		for (size_t msg_size : control_sizes) {
+			for (size_t call_process_id_size : control_sizes) {
+				helper.requestor_id = rng() % 65536;
+				helper.instance_id = rng() % 65536;
+				helper.func_id = rng() % 4096;
+				helper.control_ack = control_acks[rng() % 3];
+				helper.control_header_size = header_size;
+				helper.control_msg_size = msg_size;
+				helper.call_process_id_size = call_process_id_size;
+				diff_control_request(result, helper);
+			}
+		}
+	}
+
+	// PDUs around the longest the hand-written encoder takes, the longer ones go to asn1c
+	for (long control_ack : control_acks) {
+		for (size_t total = CONTROL_REQUEST_FAST_MAX_SIZE - 80; total <= CONTROL_REQUEST_FAST_MAX_SIZE + 8; total++) {
+			helper.control_ack = control_ack;
+			helper.call_process_id_size = total % 3 == 0 ? 0 : 4;
+			helper.control_msg_size = 36;
+			helper.control_header_size = total - helper.control_msg_size - helper.call_process_id_size;
+			diff_control_request(result, helper);
+		}
+	}
+
+	// values out of their constraints must fail the same way
+	static const long bad_ids[] = {-1, 65536, 1L << 32};
+	for (long bad_id : bad_ids) {
+		helper = ric_control_helper();
+		helper.control_header = (uint8_t *) header.data();
+		helper.control_header_size = 17;
+		helper.control_msg = (uint8_t *) msg.data();
+		helper.control_msg_size = 36;
+		helper.requestor_id = bad_id;
+		diff_control_request(result, helper);
+		helper.requestor_id = 1;
+		helper.instance_id = bad_id;
+		diff_control_request(result, helper);
+		helper.instance_id = 1;
+		helper.func_id = bad_id == 65536 ? 4096 : bad_id;
+		diff_control_request(result, helper);
+		helper.func_id = 0;
+		helper.control_ack = bad_id == -1 ? -2 : RICcontrolAckRequest_ack + 1;
+		diff_control_request(result, helper);
+	}
+
+	helper.control_header = (uint8_t *) header.data();
+	helper.control_msg = (uint8_t *) msg.data();
+	helper.call_process_id = (uint8_t *) call_process_id.data();
+	for (int i = 0; i < DIFFTEST_RANDOM_CASES; i++) {
+		helper.requestor_id = rng() % 65536;
+		helper.instance_id = rng() % 65536;
+		helper.func_id = rng() % 4096;
+		helper.control_ack = control_acks[rng() % 3];
+		helper.control_header_size = i % 4 == 0 ? control_sizes[rng() % num_sizes] : rng() % 300;
+		helper.control_msg_size = i % 4 == 1 ? control_sizes[rng() % num_sizes] : rng() % 300;
+		helper.call_process_id_size = i % 4 == 2 ? control_sizes[rng() % num_sizes] : rng() % 80;
+		diff_control_request(result, helper);
+	}
+
+	return result;
+}
+
+/*
+	RIC indication, IndicationView against the asn1c decode and ric_indication::get_fields().
+	Whenever the view takes a PDU asn1c must decode it to the same fields. The view may turn
+	down what it does not understand, which only costs the fallback to asn1c, but it must take
+	every PDU the E2 nodes send without fragmented lengths.
+*/
+static const long indication_ids[] = {0, 1, 127, 128, 255, 256, 65534, 65535};
+static const long indication_func_ids[] = {0, 1, 127, 128, 255, 256, 4094, 4095};
+static const long indication_action_ids[] = {0, 1, 127, 128, 255};
+static const long indication_sns[] = {0, 1, 255, 256, 65535};
+static const long indication_types[] = {RICindicationType_report, RICindicationType_insert};
+static const size_t indication_sizes[] = {0, 1, 2, 63, 64, 65, 125, 126, 127, 128, 129, 130, 254, 255, 256, 1000, 8000};
+
+// the ways an E2 node may lay out the same indication
+enum indication_layout {
+	INDICATION_AS_ENCODED,
+	INDICATION_WITHOUT_SN,	// the SN is optional
+	INDICATION_SHUFFLED,	// IEs in any order
+	INDICATION_LAYOUTS
+};
+
+static std::string describe_indication(const ric_indication_helper &helper, int layout) {
+	char buf[256];
+	snprintf(buf, sizeof(buf), "requestor %ld instance %ld function %ld action %ld sn %ld type %ld header %zu message %zu call process id %zu layout %d",
+			helper.request_id.ricRequestorID, helper.request_id.ricInstanceID, helper.func_id, helper.action_id,
+			helper.indication_sn, helper.indication_type, helper.indication_header.size, helper.indication_msg.size,
+			helper.call_process_id.size, layout);
+	return buf;
+}
+
+static bool same_octets(const OCTET_STRING_t &a, const OCTET_STRING_t &b) {
+	return a.size == b.size && (a.size == 0 || memcmp(a.buf, b.buf, a.size) == 0);
+}
+
+static bool same_indication(const ric_indication_helper &a, const ric_indication_helper &b) {
+	return a.request_id.ricRequestorID == b.request_id.ricRequestorID && a.request_id.ricInstanceID == b.request_id.ricInstanceID
+			&& a.func_id == b.func_id && a.action_id == b.action_id && a.indication_sn == b.indication_sn
+			&& a.indication_type == b.indication_type && same_octets(a.call_process_id, b.call_process_id)
+			&& same_octets(a.indication_header, b.indication_header) && same_octets(a.indication_msg, b.indication_msg);
+}
+
+// An RIC indication of 16384 octets or more has a fragmented open type length, and then so may its IEs
+static bool fragmented_indication(const std::vector<uint8_t> &pdu) {
+	return pdu.size() > 3 && (pdu[3] & 0xc0) == 0xc0;
+}
+
+static E2AP_PDU_t *asn1c_decode_indication(const std::vector<uint8_t> &pdu) {
+	E2AP_PDU_t *e2pdu = NULL;
+
+	asn_dec_rval_t rval = asn_decode(NULL, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2AP_PDU, (void **) &e2pdu, pdu.data(), pdu.size());
+	if (rval.code != RC_OK || e2pdu->present != E2AP_PDU_PR_initiatingMessage
+			|| e2pdu->choice.initiatingMessage->procedureCode != ProcedureCode_id_RICindication
+			|| e2pdu->choice.initiatingMessage->value.present != InitiatingMessage__value_PR_RICindication) {
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, e2pdu);
+		return NULL;
+	}
+	return e2pdu;
+}
+
+// re-encodes the indication with asn1c in the given layout
+static bool layout_indication(std::vector<uint8_t> &pdu, int layout, std::mt19937 &rng) {
+	E2AP_PDU_t *e2pdu = asn1c_decode_indication(pdu);
+	if (e2pdu == NULL) {
+		return false;
+	}
+
+	RICindication_t *indication = &e2pdu->choice.initiatingMessage->value.choice.RICindication;
+	for (int i = 0; layout == INDICATION_WITHOUT_SN && i < indication->protocolIEs.list.count; i++) {
+		RICindication_IEs_t *ie = indication->protocolIEs.list.array[i];
+		if (ie->id == ProtocolIE_ID_id_RICindicationSN) {
+			asn_sequence_del(&indication->protocolIEs.list, i, 0);
+			ASN_STRUCT_FREE(asn_DEF_RICindication_IEs, ie);
+		}
+	}
+	if (layout == INDICATION_SHUFFLED) {
+		std::shuffle(indication->protocolIEs.list.array, indication->protocolIEs.list.array + indication->protocolIEs.list.count, rng);
+	}
+
+	bool res = bench_encode(&asn_DEF_E2AP_PDU, e2pdu, pdu);
+	ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, e2pdu);
+	return res;
+}
+
+// must_parse is set for the PDUs the view is required to take
+static void diff_indication_pdu(difftest_result &result, const std::vector<uint8_t> &pdu, bool must_parse, const std::string &what) {
+	IndicationView view;
+	ric_indication_helper view_helper;
+	bool view_ok = view.parse(pdu.data(), pdu.size()) && view.get_fields(view_helper);
+	if (!view_ok) {
+		result.check(!must_parse, what + ": turned down by the view, " + view.get_error());
+		return;
+	}
+
+	ric_indication indication;
+	ric_indication_helper asn1c_helper;
+	E2AP_PDU_t *e2pdu = asn1c_decode_indication(pdu);
+	bool same = e2pdu != NULL && indication.get_fields(e2pdu->choice.initiatingMessage, asn1c_helper)
+			&& same_indication(view_helper, asn1c_helper);
+	result.check(same, what + (e2pdu == NULL ? ": taken by the view, not decoded by asn1c" : ": fields differ"));
+	ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, e2pdu);
+}
+
+static void diff_indication(difftest_result &result, ric_indication_helper &helper, int layout, std::mt19937 &rng) {
+	std::vector<uint8_t> pdu;
+	std::string error;
+
+	// asn1c does not decode the fragmented encodings it writes, so those are only taken as encoded
+	if (!bench_encode_indication(helper, pdu, error)
+			|| (layout != INDICATION_AS_ENCODED && !fragmented_indication(pdu) && !layout_indication(pdu, layout, rng))) {
+		result.check(false, describe_indication(helper, layout) + ": not encoded, " + error);
+		return;
+	}
+	diff_indication_pdu(result, pdu, !fragmented_indication(pdu), describe_indication(helper, layout));
+}
+
+static difftest_result difftest_indication_view(std::mt19937 &rng) {
+	difftest_result result("indication view");
+	std::vector<uint8_t> filler = bench_bytes(32768, 1);	// headers of any length
+	std::vector<uint8_t> msg = bench_bytes(32768, 2);
+	std::vector<uint8_t> call_process_id = bench_bytes(32768, 3);
+	std::vector<std::vector<uint8_t>> headers;
+	const size_t num_sizes = sizeof(indication_sizes) / sizeof(indication_sizes[0]);
+	ric_indication_helper helper;
+
+	for (int format = 0; format < BENCH_HEADER_FORMATS; format++) {
+		for (int shape = 0; shape < BENCH_UEID_SHAPES; shape++) {
+			headers.emplace_back();
+			if (!bench_encode_indication_header(format, shape, format * BENCH_UEID_SHAPES + shape, headers.back())) {
+				result.check(false, "indication header format " + std::to_string(format) + " not encoded");
+			}
+		}
+	}
+
+	// every header shape with every combination of octet string lengths, in every layout
+	bench_fill_indication(helper, headers[0], msg, call_process_id);
+	for (const std::vector<uint8_t> &header : headers) {
+		for (size_t msg_size : indication_sizes) {
+			for (size_t call_process_id_size : indication_sizes) {
+				helper.indication_header.buf = (uint8_t *) header.data();
+				helper.indication_header.size = header.size();
+				helper.indication_msg.size = msg_size;
+				helper.call_process_id.size = call_process_id_size;
+				diff_indication(result, helper, rng() % INDICATION_LAYOUTS, rng);
+			}
+		}
+	}
+
+	// every id at the edges of its range
+	helper.indication_header.buf = filler.data();
+	for (long requestor_id : indication_ids) {
+		for (long instance_id : indication_ids) {
+			for (long func_id : indication_func_ids) {
+				for (long action_id : indication_action_ids) {
+					for (long indication_sn : indication_sns) {
+						for (long indication_type : indication_types) {
+							helper.request_id.ricRequestorID = requestor_id;
+							helper.request_id.ricInstanceID = instance_id;
+							helper.func_id = func_id;
+							helper.action_id = action_id;
+							helper.indication_sn = indication_sn;
+							helper.indication_type = indication_type;
+							helper.indication_header.size = indication_sizes[rng() % num_sizes];
+							helper.indication_msg.size = indication_sizes[rng() % num_sizes];
+							helper.call_process_id.size = indication_sizes[rng() % num_sizes];
+							diff_indication(result, helper, INDICATION_AS_ENCODED, rng);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// PDUs around the longest one without fragmented lengths
+	bench_fill_indication(helper, headers[0], msg, call_process_id);
+	for (size_t msg_size = 16300; msg_size <= 16400; msg_size++) {
+		for (int layout = 0; layout < INDICATION_LAYOUTS; layout++) {
+			helper.indication_msg.size = msg_size;
+			helper.call_process_id.size = msg_size % 2 == 0 ? 0 : 4;
+			diff_indication(result, helper, layout, rng);
+		}
+	}
+	helper.indication_msg.size = 32768;
+	diff_indication(result, helper, INDICATION_AS_ENCODED, rng);
+
+	/*
+		Random indications, and the same PDUs truncated and with a few bits flipped: the view may
+		take a damaged PDU only when asn1c decodes it to the same fields.
+	*/
+	helper.indication_msg.buf = msg.data();
+	helper.call_process_id.buf = call_process_id.data();
+	for (int i = 0; i < DIFFTEST_RANDOM_CASES; i++) {
+		const std::vector<uint8_t> &header = headers[rng() % headers.size()];
+		helper.request_id.ricRequestorID = rng() % 65536;
+		helper.request_id.ricInstanceID = rng() % 65536;
+		helper.func_id = rng() % 4096;
+		helper.action_id = rng() % 256;
+		helper.indication_sn = rng() % 65536;
+		helper.indication_type = indication_types[rng() % 2];
+		helper.indication_header.buf = i % 4 == 0 ? filler.data() : (uint8_t *) header.data();
+		helper.indication_header.size = i % 4 == 0 ? rng() % 300 : header.size();
+		helper.indication_msg.size = i % 4 == 1 ? indication_sizes[rng() % num_sizes] : rng() % 300;
+		helper.call_process_id.size = i % 4 == 2 ? indication_sizes[rng() % num_sizes] : rng() % 80;
+		int layout = rng() % INDICATION_LAYOUTS;
+		diff_indication(result, helper, layout, rng);
+
+		std::vector<uint8_t> pdu;
+		std::string error;
+		if (!bench_encode_indication(helper, pdu, error) || !layout_indication(pdu, layout, rng)) {
+			continue;
+		}
+		if (i % 3 == 0) {
+			pdu.resize(rng() % pdu.size());
+		}
+		for (int flips = rng() % 4; flips > 0 && !pdu.empty(); flips--) {
+			pdu[rng() % pdu.size()] ^= 1 << (rng() % 8);
+		}
+		diff_indication_pdu(result, pdu, false, describe_indication(helper, layout) + " damaged");
+	}
+
+	return result;
+}
+
+/*
+	UEID decoder, e2sm_rc_ueid_decoder against the asn1c decode of the whole indication header.
+	Whenever asn1c finds a UEID in a header the decoder must find the same one, and it must fail
+	when there is none. Equal UEIDs must get equal keys whatever the header format, different
+	UEIDs different keys, and the control header built around the UEID bits must be the one
+	asn1c encodes. The decoder may take a damaged header that asn1c turns down, since it does not
+	look past the UEID.
+
+	Keys and spliced control headers are made of the UEID bits as received, so a damaged header
+	with non-zero alignment padding, which asn1c skips, gives another key and a control header
+	that only decodes the same. Keys are checked on undamaged headers only.
+*/
+#define DIFFTEST_UEID_SEEDS 2000	// per header format and UEID shape
+#define DIFFTEST_UEID_FILL_LENGTH 64	// for asn_random_fill()
+
+struct ueid_keys {
+	std::map<std::string, std::string> by_ueid;	// APER encoding of the UEID alone to its key
+	std::map<std::string, std::string> by_key;
+};
+
+static int append_string(const void *buf, size_t size, void *app_key) {
+	((std::string *) app_key)->append((const char *) buf, size);
+	return 0;
+}
+
+// XER, unlike APER, is written for values out of their constraints as well
+static std::string ueid_xer(const UEID_t *ueid) {
+	std::string xer;
+	xer_encode(&asn_DEF_UEID, ueid, XER_F_CANONICAL, append_string, &xer);
+	return xer;
+}
+
+static const UEID_t *asn1c_header_ueid(const E2SM_RC_IndicationHeader_t *header) {
+	switch (header->ric_indicationHeader_formats.present) {
+		case E2SM_RC_IndicationHeader__ric_indicationHeader_formats_PR_indicationHeader_Format2:
+			return &header->ric_indicationHeader_formats.choice.indicationHeader_Format2->ueID;
+		case E2SM_RC_IndicationHeader__ric_indicationHeader_formats_PR_indicationHeader_Format3:
+			return header->ric_indicationHeader_formats.choice.indicationHeader_Format3->ueID;
+		default:
+			return NULL;
+	}
+}
+
+static void diff_ueid_key(difftest_result &result, ueid_keys &keys, const std::vector<uint8_t> &ueid, const e2sm_rc_ueid_ref &ref, const std::string &what) {
+	std::string ueid_bytes(ueid.begin(), ueid.end());
+	std::string key((const char *) ref.key.bytes, E2SM_RC_UE_KEY_SIZE);
+
+	auto by_ueid = keys.by_ueid.insert(std::make_pair(ueid_bytes, key));
+	result.check(by_ueid.first->second == key, what + ": another key for the same UEID");
+	auto by_key = keys.by_key.insert(std::make_pair(key, ueid_bytes));
+	result.check(by_key.first->second == ueid_bytes, what + ": the same key for another UEID");
+}
+
+static void diff_ueid_splice(difftest_result &result, const UEID_t *asn1c_ueid, const e2sm_rc_ueid_ref &ref, UEID_t *ueid,
+		bool damaged, const std::string &what) {
+	uint8_t asn1c_buf[BENCH_BUFFER_SIZE], splice_buf[BENCH_BUFFER_SIZE];
+	ssize_t asn1c_size = sizeof(asn1c_buf);
+	ssize_t splice_size = sizeof(splice_buf);
+	e2sm_control asn1c_control, splice_control;
+
+	// spliced at MDCLOG_ERR whenever the UEID bits can be copied, asn1c otherwise
+	bool asn1c_ok = asn1c_control.encode_rc_control_header(asn1c_buf, &asn1c_size, (UEID_t *) asn1c_ueid);
+	bool splice_ok = splice_control.encode_rc_control_header(splice_buf, &splice_size, ref, ueid);
+	if (asn1c_ok && splice_ok && damaged) {
+		// encoded again by asn1c, which leaves out the padding bits
+		E2SM_RC_ControlHeader_t *control_header = NULL;
+		std::vector<uint8_t> bytes;
+		splice_ok = asn_decode(NULL, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2SM_RC_ControlHeader, (void **) &control_header, splice_buf, splice_size).code == RC_OK
+				&& bench_encode(&asn_DEF_E2SM_RC_ControlHeader, control_header, bytes) && bytes.size() <= sizeof(splice_buf);
+		if (splice_ok) {
+			splice_size = bytes.size();
+			memcpy(splice_buf, bytes.data(), splice_size);
+		}
+		ASN_STRUCT_FREE(asn_DEF_E2SM_RC_ControlHeader, control_header);
+	}
+	result.check(asn1c_ok && splice_ok && asn1c_size == splice_size && memcmp(asn1c_buf, splice_buf, asn1c_size) == 0,
+			what + ": control header differs");
+}
+
+static void diff_ueid(difftest_result &result, ueid_keys &keys, const std::vector<uint8_t> &header, bool damaged, const std::string &what) {
+	E2SM_RC_IndicationHeader_t *decoded = NULL;
+	asn_dec_rval_t rval = asn_decode(NULL, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2SM_RC_IndicationHeader, (void **) &decoded, header.data(), header.size());
+	const UEID_t *asn1c_ueid = rval.code == RC_OK ? asn1c_header_ueid(decoded) : NULL;
+
+	e2sm_rc_ueid_decoder decoder;
+	e2sm_rc_ueid_ref ref;
+	UEID_t *ueid = NULL;
+	bool decoder_ok = decoder.decode(header.data(), header.size(), ref, &ueid);
+
+	std::vector<uint8_t> asn1c_bytes;
+	if (rval.code != RC_OK) {
+		result.check(true, what);	// only required not to crash
+	} else if (asn1c_ueid == NULL) {
+		result.check(!decoder_ok, what + ": UEID found where asn1c has none");
+	} else if (!decoder_ok) {
+		// a UEID out of its constraints, which asn1c decodes but does not encode, has no key
+		result.check(!bench_encode(&asn_DEF_UEID, asn1c_ueid, asn1c_bytes), what + ": " + decoder.get_error());
+	} else {
+		bool same = ueid_xer(asn1c_ueid) == ueid_xer(ueid);
+		result.check(same, what + ": UEID differs");
+		if (same && bench_encode(&asn_DEF_UEID, asn1c_ueid, asn1c_bytes)) {
+			if (!damaged) {
+				diff_ueid_key(result, keys, asn1c_bytes, ref, what);
+			}
+			diff_ueid_splice(result, asn1c_ueid, ref, ueid, damaged, what);
+		}
+	}
+
+	ASN_STRUCT_FREE(asn_DEF_UEID, ueid);
+	ASN_STRUCT_FREE(asn_DEF_E2SM_RC_IndicationHeader, decoded);
+}
+
+// encodes the header and runs it through both, also damaged; the header is freed
+static void diff_ueid_header(difftest_result &result, ueid_keys &keys, E2SM_RC_IndicationHeader_t *header, const std::string &what, std::mt19937 &rng) {
+	std::vector<uint8_t> bytes;
+	bool encoded = bench_encode(&asn_DEF_E2SM_RC_IndicationHeader, header, bytes);
+	ASN_STRUCT_FREE(asn_DEF_E2SM_RC_IndicationHeader, header);
+	if (!encoded) {
+		return;	// asn_random_fill() does not keep to every constraint
+	}
+	diff_ueid(result, keys, bytes, false, what);
+
+	if (rng() % 2 && !bytes.empty()) {
+		bytes.resize(rng() % bytes.size());
+	}
+	for (int flips = rng() % 4; flips > 0 && !bytes.empty(); flips--) {
+		bytes[rng() % bytes.size()] ^= 1 << (rng() % 8);
+	}
+	diff_ueid(result, keys, bytes, true, what + " damaged");
+}
+
+static difftest_result difftest_ueid_decoder(std::mt19937 &rng) {
+	difftest_result result("ueid decoder");
+	ueid_keys keys;
+
+	// the UEID shapes of the E2 nodes, each one in every header format
+	for (unsigned int seed = 0; seed < DIFFTEST_UEID_SEEDS; seed++) {
+		for (int shape = 0; shape < BENCH_UEID_SHAPES; shape++) {
+			for (int format = 0; format < BENCH_HEADER_FORMATS; format++) {
+				diff_ueid_header(result, keys, bench_make_indication_header(format, shape, seed),
+						"seed " + std::to_string(seed) + " shape " + std::to_string(shape) + " format " + std::to_string(format), rng);
+			}
+		}
+	}
+
+	// any UEID asn1c makes up in every header format, and any header
+	for (int i = 0; i < DIFFTEST_RANDOM_CASES / BENCH_HEADER_FORMATS; i++) {
+		UEID_t *ueid = NULL;
+		if (asn_random_fill(&asn_DEF_UEID, (void **) &ueid, DIFFTEST_UEID_FILL_LENGTH) != 0) {
+			result.check(false, "random UEID not filled");
+			continue;
+		}
+		for (int format = 0; format < BENCH_HEADER_FORMATS; format++) {
+			UEID_t *copy = NULL;
+			std::vector<uint8_t> bytes;
+			if (bench_encode(&asn_DEF_UEID, ueid, bytes)
+					&& asn_decode(NULL, ATS_ALIGNED_BASIC_PER, &asn_DEF_UEID, (void **) &copy, bytes.data(), bytes.size()).code == RC_OK) {
+				diff_ueid_header(result, keys, bench_make_indication_header(format, copy, i),
+						"random UEID " + std::to_string(i) + " format " + std::to_string(format), rng);
+			} else {
+				ASN_STRUCT_FREE(asn_DEF_UEID, copy);
+			}
+		}
+		ASN_STRUCT_FREE(asn_DEF_UEID, ueid);
+
+		E2SM_RC_IndicationHeader_t *header = NULL;
+		if (asn_random_fill(&asn_DEF_E2SM_RC_IndicationHeader, (void **) &header, DIFFTEST_UEID_FILL_LENGTH) != 0) {
+			result.check(false, "random indication header not filled");
+			continue;
+		}
+		diff_ueid_header(result, keys, header, "random header " + std::to_string(i), rng);
+	}
+
+	// and anything at all
+	for (int i = 0; i < DIFFTEST_RANDOM_CASES; i++) {
+		std::vector<uint8_t> bytes(rng() % 32);
+		for (uint8_t &octet : bytes) {
+			octet = rng();
+		}
+		diff_ueid(result, keys, bytes, true, "random octets " + std::to_string(i));
+	}
+
+	return result;
+}
+
+/*
+	Bit I/O, asn1c_defs/asn_bit_data.c against the original asn1c one kept in asn_bit_data_ref.c.
+	Random reads from buffers of random lengths, ending on any bit, must return the same values
+	and errors and move to the same position, and random writes must give the same output.
+*/
+#define DIFFTEST_BITIO_READS 20	// per buffer
+#define DIFFTEST_BITIO_WRITES 30	// per output
+
+static size_t bit_position(const asn_bit_data_t &pd, const uint8_t *buf) {
+	return (pd.buffer - buf) * 8 + pd.nboff;
+}
+
+static void diff_bit_reads(difftest_result &result, int sequence, std::mt19937 &rng) {
+	size_t size = rng() % 96;
+	size_t nbits = size * 8 - (size ? rng() % 8 : 0);
+	// exactly size octets on the heap, so that a sanitizer catches reads past the end
+	uint8_t *buf = (uint8_t *) malloc(size ? size : 1);
+	for (size_t i = 0; i < size; i++) {
+		buf[i] = rng();
+	}
+
+	asn_bit_data_t pd, ref_pd;
+	memset(&pd, 0, sizeof(pd));
+	pd.buffer = buf;
+	pd.nbits = nbits;
+	ref_pd = pd;
+
+	for (int i = 0; i < DIFFTEST_BITIO_READS; i++) {
+		std::string what = "read " + std::to_string(sequence) + "." + std::to_string(i) + " of " + std::to_string(nbits) + " bits";
+		if (rng() % 3) {
+			int n = rng() % 34;
+			int32_t value = asn_get_few_bits(&pd, n);
+			int32_t ref_value = asn_ref_get_few_bits(&ref_pd, n);
+			result.check(value == ref_value, what + ": " + std::to_string(n) + " bits read as " + std::to_string(value)
+					+ " instead of " + std::to_string(ref_value));
+		} else {
+			int n = rng() % (nbits + 16);
+			int right_align = rng() % 2;
+			uint8_t dst[128] = {0};
+			uint8_t ref_dst[128] = {0};
+			int res = asn_get_many_bits(&pd, dst, right_align, n);
+			int ref_res = asn_ref_get_many_bits(&ref_pd, ref_dst, right_align, n);
+			result.check(res == ref_res && memcmp(dst, ref_dst, sizeof(dst)) == 0,
+					what + ": " + std::to_string(n) + " bits read differently, right aligned " + std::to_string(right_align));
+			if (res < 0) {
+				break;	// the position after a failed read is unspecified
+			}
+		}
+		if (bit_position(pd, buf) != bit_position(ref_pd, buf) || pd.moved != ref_pd.moved) {
+			result.check(false, what + ": moved to another position");
+			break;
+		}
+	}
+
+	free(buf);
+}
+
+static void diff_bit_writes(difftest_result &result, int sequence, std::mt19937 &rng) {
+	std::string output, ref_output;
+	asn_bit_outp_t po, ref_po;
+
+	memset(&po, 0, sizeof(po));
+	po.buffer = po.tmpspace;
+	po.nbits = 8 * sizeof(po.tmpspace);
+	po.output = append_string;
+	ref_po = po;
+	ref_po.buffer = ref_po.tmpspace;	// the output points into its own tmpspace
+	po.op_key = &output;
+	ref_po.op_key = &ref_output;
+
+	for (int i = 0; i < DIFFTEST_BITIO_WRITES; i++) {
+		std::string what = "write " + std::to_string(sequence) + "." + std::to_string(i);
+		int op = rng() % 10;
+		if (op < 6) {
+			uint32_t bits = rng();
+			int n = rng() % 33;
+			result.check(asn_put_few_bits(&po, bits, n) == asn_ref_put_few_bits(&ref_po, bits, n), what + ": " + std::to_string(n) + " bits");
+		} else if (op < 9) {
+			uint8_t src[200];
+			for (uint8_t &octet : src) {
+				octet = rng();
+			}
+			int n = rng() % (8 * sizeof(src));
+			result.check(asn_put_many_bits(&po, src, n) == asn_ref_put_many_bits(&ref_po, src, n), what + ": " + std::to_string(n) + " bits");
+		} else {
+			result.check(asn_put_aligned_flush(&po) == asn_ref_put_aligned_flush(&ref_po), what + ": flush");
+		}
+	}
+
+	asn_put_aligned_flush(&po);
+	asn_ref_put_aligned_flush(&ref_po);
+	result.check(output == ref_output && po.flushed_bytes == ref_po.flushed_bytes,
+			"write " + std::to_string(sequence) + ": " + std::to_string(output.size()) + " octets written instead of " + std::to_string(ref_output.size()));
+}
+
+static difftest_result difftest_bit_io(std::mt19937 &rng) {
+	difftest_result result("bit i/o");
+
+	for (int i = 0; i < DIFFTEST_RANDOM_CASES; i++) {
+		diff_bit_reads(result, i, rng);
+		diff_bit_writes(result, i, rng);
+	}
+
+	return result;
+}
+
+int main(void) {
+	std::mt19937 rng(DIFFTEST_SEED);
+	unsigned long mismatches = 0;
+
+	mdclog_level_set(MDCLOG_ERR);	// at DEBUG the hand-written encoder checks itself against asn1c
+	srandom(DIFFTEST_SEED);		// for asn_random_fill()
+
+	std::vector<difftest_result> results;
+	results.push_back(difftest_control_request(rng));
+	results.push_back(difftest_indication_view(rng));
+	results.push_back(difftest_ueid_decoder(rng));
+	results.push_back(difftest_bit_io(rng));
+
+	for (const difftest_result &result : results) {
+		result.report();
+		mismatches += result.mismatches;
+	}
+
+	printf("%s\n", mismatches ? "FAILED" : "PASSED");
+	return mismatches != 0;
+}
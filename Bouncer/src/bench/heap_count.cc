@@ -0,0 +1,52 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+
+/*
+ * heap_count.cc
+ *
+ * Wrappers of the C library allocator counting the allocations of the calling thread.
+ * Linking this file into a binary is enough to have them replace malloc, calloc and realloc.
+ */
+
+#include "heap_count.hpp"
+
+extern "C" void *__libc_malloc(size_t);
+extern "C" void *__libc_calloc(size_t, size_t);
+extern "C" void *__libc_realloc(void *, size_t);
+
+thread_local size_t heap_allocs;
+thread_local size_t heap_bytes;
+
+extern "C" void *malloc(size_t size) {
+	heap_allocs++;
+	heap_bytes += size;
+	return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size) {
+	heap_allocs++;
+	heap_bytes += nmemb * size;
+	return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+	heap_allocs++;
+	heap_bytes += size;
+	return __libc_realloc(ptr, size);
+}
@@ -0,0 +1,38 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+
+/*
+ * heap_count.hpp
+ *
+ * Heap accounting of the bench tools. heap_count.cc wraps the C library allocator, so that
+ * the allocations of both asn1c and the C++ code are counted, per thread.
+ */
+
+#pragma once
+
+#ifndef BENCH_HEAP_COUNT_HPP_
+#define BENCH_HEAP_COUNT_HPP_
+
+#include <stddef.h>
+
+// malloc, calloc and realloc calls made by the calling thread, and the bytes they asked for
+extern thread_local size_t heap_allocs;
+extern thread_local size_t heap_bytes;
+
+#endif /* BENCH_HEAP_COUNT_HPP_ */
@@ -0,0 +1,426 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+/*
+ * e2load.cc
+ *
+ * Synthetic E2 node load generator: stands in for one or many E2 nodes in front of the xapp.
+ *
+ * E2SM-RC insert indications (Format2 headers, one UEID per simulated UE) are sent over RMR
+ * either at a fixed rate (-r) or with a fixed number of indications in flight (-c), and the
+ * RIC control requests the xapp returns are decoded to measure the round trip latency.
+ *
+ * The xapp answers with rts, so e2load only needs a route for RIC_INDICATION, e.g.
+ *   RMR_SEED_RT=./routes.txt ./e2load -r 50000 -n 8 -d 30
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mdclog/mdclog.h>
+#include <rmr/rmr.h>
+#include <rmr/RIC_message_types.h>
+
+#include "e2ap_indication.hpp"
+#include "e2ap_control.hpp"
+
+extern "C" {
+	#include "E2AP-PDU.h"
+	#include "E2SM-RC-IndicationHeader.h"
+	#include "E2SM-RC-IndicationHeader-Format2.h"
+	#include "UEID-GNB.h"
+}
+
+#define E2LOAD_CALL_PROCESS_ID_SIZE 16	// sequence number and send time, both 64 bits big endian
+#define E2LOAD_DRAIN_TIMEOUT 2	// seconds to wait for the last control requests
+#define E2LOAD_SLOT_TIMEOUT 1	// seconds before a closed loop slot is considered lost
+
+struct load_options {
+	std::string port = "4591";	// RMR listen port of e2load itself
+	int msg_size = 2072;
+	int nodes = 1;			// simulated E2 nodes, each one with its own MEID
+	int ues = 1000;			// distinct UEIDs, spread over the nodes
+	double rate = 0;		// indications per second, 0 for closed loop
+	int concurrency = 1;		// indications in flight when running closed loop
+	int duration = 10;		// seconds
+	long requestor_id = 1;
+	long function_id = 1;
+};
+
+struct load_stats {
+	std::atomic<uint64_t> sent{0};
+	std::atomic<uint64_t> send_errors{0};
+	std::atomic<uint64_t> received{0};
+	std::atomic<uint64_t> decode_errors{0};
+	std::atomic<uint64_t> unexpected{0};	// messages other than RIC control requests
+	std::atomic<uint64_t> timeouts{0};	// closed loop slots given up on
+	std::vector<uint64_t> latencies;	// ns, written by the receive thread only
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void signal_handler(int) {
+	stop_requested = 1;
+}
+
+static uint64_t now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void put_be64(uint8_t *buf, uint64_t value) {
+	for (int i = 7; i >= 0; i--, value >>= 8) {
+		buf[i] = value & 0xff;
+	}
+}
+
+static uint64_t get_be64(const uint8_t *buf) {
+	uint64_t value = 0;
+	for (int i = 0; i < 8; i++) {
+		value = (value << 8) | buf[i];
+	}
+	return value;
+}
+
+static void set_bits(BIT_STRING_t *bits, unsigned int value, int nbits) {
+	int size = (nbits + 7) / 8;
+
+	bits->buf = (uint8_t *) calloc(1, size);
+	bits->size = size;
+	bits->bits_unused = size * 8 - nbits;
+	value <<= bits->bits_unused;
+	for (int i = size - 1; i >= 0; i--, value >>= 8) {
+		bits->buf[i] = value & 0xff;
+	}
+}
+
+/*
+	Encodes the E2SM-RC indication header of every simulated UE. The UEs differ in their
+	AMF UE NGAP ID and GUAMI, so that the UEIDs have different values and encoded lengths.
+*/
+static bool encode_indication_headers(int ues, std::vector<std::vector<uint8_t>> &headers) {
+	uint8_t buf[512];
+
+	for (int i = 0; i < ues; i++) {
+		E2SM_RC_IndicationHeader_t *header = (E2SM_RC_IndicationHeader_t *) calloc(1, sizeof(E2SM_RC_IndicationHeader_t));
+		E2SM_RC_IndicationHeader_Format2_t *format2 = (E2SM_RC_IndicationHeader_Format2_t *) calloc(1, sizeof(E2SM_RC_IndicationHeader_Format2_t));
+		header->ric_indicationHeader_formats.present = E2SM_RC_IndicationHeader__ric_indicationHeader_formats_PR_indicationHeader_Format2;
+		header->ric_indicationHeader_formats.choice.indicationHeader_Format2 = format2;
+		format2->ric_InsertStyle_Type = 2;
+		format2->ric_InsertIndication_ID = 1;
+
+		UEID_GNB_t *gnb = (UEID_GNB_t *) calloc(1, sizeof(UEID_GNB_t));
+		format2->ueID.present = UEID_PR_gNB_UEID;
+		format2->ueID.choice.gNB_UEID = gnb;
+		asn_ulong2INTEGER(&gnb->amf_UE_NGAP_ID, (unsigned long) i * 7919 + 1);	// spans 1 to 5 octets
+		OCTET_STRING_fromBuf(&gnb->guami.pLMNIdentity, "\x00\xf1\x10", 3);
+		set_bits(&gnb->guami.aMFRegionID, 128 + i % 8, 8);
+		set_bits(&gnb->guami.aMFSetID, i % 1024, 10);
+		set_bits(&gnb->guami.aMFPointer, i % 64, 6);
+
+		asn_enc_rval_t retval = asn_encode_to_buffer(0, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2SM_RC_IndicationHeader, header, buf, sizeof(buf));
+		ASN_STRUCT_FREE(asn_DEF_E2SM_RC_IndicationHeader, header);
+		if (retval.encoded < 0 || retval.encoded > (ssize_t) sizeof(buf)) {
+			fprintf(stderr, "unable to encode the indication header of UE %d: %s\n", i,
+					retval.failed_type ? retval.failed_type->name : "buffer too small");
+			return false;
+		}
+		headers.emplace_back(buf, buf + retval.encoded);
+	}
+
+	return true;
+}
+
+/*
+	Sends indications until the duration is over. When running at a fixed rate, the scheduled
+	send time is used as the start of the round trip, so that a stalled xapp shows up in the
+	latencies instead of just slowing down the load.
+*/
+static void send_loop(void *rmr_ctx, const load_options &opts, const std::vector<std::vector<uint8_t>> &headers,
+		load_stats &stats, sem_t *slots) {
+	static uint8_t indication_msg[] = {0x00};	// the xapp does not look into the message
+	std::vector<std::string> meids;
+	ric_indication indication;
+	ric_indication_helper helper;
+	uint8_t call_process_id[E2LOAD_CALL_PROCESS_ID_SIZE];
+	uint64_t interval = opts.rate > 0 ? (uint64_t) (1e9 / opts.rate) : 0;
+	uint64_t start = now_ns();
+	uint64_t end = start + (uint64_t) opts.duration * 1000000000ULL;
+	uint64_t next = start;
+
+	for (int i = 0; i < opts.nodes; i++) {
+		char meid[RMR_MAX_MEID];
+		snprintf(meid, sizeof(meid), "gnb_e2load_%03d", i);
+		meids.push_back(meid);
+	}
+
+	helper.request_id.ricRequestorID = opts.requestor_id;
+	helper.request_id.ricInstanceID = 1;
+	helper.func_id = opts.function_id;
+	helper.action_id = 1;
+	helper.indication_type = RICindicationType_insert;
+	helper.indication_msg.buf = indication_msg;
+	helper.indication_msg.size = sizeof(indication_msg);
+	helper.call_process_id.buf = call_process_id;
+	helper.call_process_id.size = sizeof(call_process_id);
+
+	rmr_mbuf_t *mbuf = rmr_alloc_msg(rmr_ctx, opts.msg_size);
+
+	for (uint64_t seq = 0; !stop_requested; seq++) {
+		uint64_t sent_at;
+
+		if (interval > 0) {
+			if (next >= end) {
+				break;
+			}
+			struct timespec ts = {(time_t) (next / 1000000000ULL), (long) (next % 1000000000ULL)};
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+			sent_at = next;
+			next += interval;
+		} else {
+			struct timespec ts;
+			clock_gettime(CLOCK_REALTIME, &ts);
+			ts.tv_sec += E2LOAD_SLOT_TIMEOUT;
+			if (sem_timedwait(slots, &ts) != 0) {
+				stats.timeouts++;	// the control request got lost, reuse its slot
+			}
+			sent_at = now_ns();
+			if (sent_at >= end) {
+				break;
+			}
+		}
+
+		// UEs are spread over the nodes, so each node always reports the same UEs
+		const std::vector<uint8_t> &header = headers[seq % headers.size()];
+		const std::string &meid = meids[(seq % headers.size()) % meids.size()];
+
+		put_be64(call_process_id, seq);
+		put_be64(call_process_id + 8, sent_at);
+		helper.indication_sn = seq & 0xffff;
+		helper.indication_header.buf = (uint8_t *) header.data();
+		helper.indication_header.size = header.size();
+
+		ssize_t size = rmr_payload_size(mbuf);
+		if (!indication.encode_e2ap_indication(mbuf->payload, &size, helper)) {
+			fprintf(stderr, "unable to encode indication %lu: %s\n", seq, indication.get_error().c_str());
+			break;
+		}
+
+		mbuf->mtype = RIC_INDICATION;
+		mbuf->sub_id = opts.requestor_id;
+		mbuf->len = size;
+		rmr_str2meid(mbuf, (unsigned char const *) meid.c_str());
+
+		mbuf = rmr_send_msg(rmr_ctx, mbuf);
+		for (int attempt = 0; mbuf != NULL && mbuf->state == RMR_ERR_RETRY && attempt < 100; attempt++) {
+			mbuf = rmr_send_msg(rmr_ctx, mbuf);
+		}
+		if (mbuf == NULL) {
+			mbuf = rmr_alloc_msg(rmr_ctx, opts.msg_size);
+			stats.send_errors++;
+		} else if (mbuf->state != RMR_OK) {
+			stats.send_errors++;
+		} else {
+			stats.sent++;
+		}
+	}
+
+	rmr_free_msg(mbuf);
+}
+
+static void receive_loop(void *rmr_ctx, load_stats &stats, sem_t *slots, std::atomic<bool> &running) {
+	ric_control_request control_req;
+	rmr_mbuf_t *mbuf = NULL;
+
+	while (running) {
+		mbuf = rmr_torcv_msg(rmr_ctx, mbuf, 100);
+		if (mbuf == NULL || mbuf->state != RMR_OK) {
+			continue;
+		}
+		uint64_t received_at = now_ns();
+
+		if (mbuf->mtype != RIC_CONTROL_REQ) {
+			stats.unexpected++;
+			continue;
+		}
+
+		E2AP_PDU_t *pdu = NULL;
+		ric_control_helper helper;
+		asn_dec_rval_t rval = asn_decode(0, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2AP_PDU, (void **) &pdu, mbuf->payload, mbuf->len);
+
+		if (rval.code != RC_OK || pdu->present != E2AP_PDU_PR_initiatingMessage
+				|| !control_req.get_fields(pdu->choice.initiatingMessage, helper)
+				|| helper.call_process_id_size != E2LOAD_CALL_PROCESS_ID_SIZE) {
+			stats.decode_errors++;
+		} else {
+			stats.latencies.push_back(received_at - get_be64(helper.call_process_id + 8));
+			stats.received++;
+		}
+		ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, pdu);
+
+		sem_post(slots);
+	}
+
+	rmr_free_msg(mbuf);
+}
+
+static void print_report(const load_options &opts, load_stats &stats, double elapsed) {
+	std::vector<uint64_t> &lat = stats.latencies;
+	std::sort(lat.begin(), lat.end());
+
+	printf("\n%d node(s), %d UE(s), ", opts.nodes, opts.ues);
+	if (opts.rate > 0) {
+		printf("open loop at %.0f indications/s\n", opts.rate);
+	} else {
+		printf("closed loop with %d indication(s) in flight\n", opts.concurrency);
+	}
+	printf("sent %lu indications in %.1f s (%.0f/s), %lu send errors\n",
+			stats.sent.load(), elapsed, stats.sent / elapsed, stats.send_errors.load());
+	printf("received %lu control requests (%.0f/s), %lu decode errors, %lu other messages, %lu lost\n",
+			stats.received.load(), stats.received / elapsed, stats.decode_errors.load(), stats.unexpected.load(),
+			stats.sent > stats.received + stats.decode_errors ? stats.sent - stats.received - stats.decode_errors : 0);
+	if (stats.timeouts > 0) {
+		printf("%lu closed loop slots timed out after %d s\n", stats.timeouts.load(), E2LOAD_SLOT_TIMEOUT);
+	}
+
+	if (lat.empty()) {
+		return;
+	}
+
+	printf("round trip latency (us):");
+	const double percentiles[] = {50, 90, 99, 99.9, 99.99};
+	for (double p : percentiles) {
+		size_t idx = std::min(lat.size() - 1, (size_t) (p / 100 * lat.size()));
+		printf("  p%g %.1f", p, lat[idx] / 1000.0);
+	}
+	printf("  max %.1f\n", lat.back() / 1000.0);
+}
+
+static void usage(const char *prog) {
+	fprintf(stderr,
+			"usage: %s [options]\n"
+			"  -p port         RMR listen port of e2load (default 4591)\n"
+			"  -n nodes        number of simulated E2 nodes (default 1)\n"
+			"  -u ues          number of distinct UEIDs (default 1000)\n"
+			"  -r rate         indications per second, open loop\n"
+			"  -c concurrency  indications in flight, closed loop (default 1, when no rate is given)\n"
+			"  -d seconds      duration of the run (default 10)\n"
+			"  -s bytes        RMR message size (default 2072)\n"
+			"  -f id           RAN function id of the indications (default 1)\n"
+			"  -q id           RIC requestor id, also used as RMR subscription id (default 1)\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+	load_options opts;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "p:n:u:r:c:d:s:f:q:h")) != -1) {
+		switch (opt) {
+			case 'p': opts.port = optarg; break;
+			case 'n': opts.nodes = atoi(optarg); break;
+			case 'u': opts.ues = atoi(optarg); break;
+			case 'r': opts.rate = atof(optarg); break;
+			case 'c': opts.concurrency = atoi(optarg); break;
+			case 'd': opts.duration = atoi(optarg); break;
+			case 's': opts.msg_size = atoi(optarg); break;
+			case 'f': opts.function_id = atol(optarg); break;
+			case 'q': opts.requestor_id = atol(optarg); break;
+			default:
+				usage(argv[0]);
+				return opt == 'h' ? 0 : 1;
+		}
+	}
+	if (opts.nodes < 1 || opts.ues < 1 || opts.concurrency < 1 || opts.duration < 1 || opts.rate < 0 || opts.msg_size < 256) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	mdclog_level_set(MDCLOG_ERR);
+	signal(SIGINT, signal_handler);
+	signal(SIGTERM, signal_handler);
+
+	std::vector<std::vector<uint8_t>> headers;
+	if (!encode_indication_headers(opts.ues, headers)) {
+		return 1;
+	}
+
+	void *rmr_ctx = rmr_init(const_cast<char *>(opts.port.c_str()), RMR_MAX_RCV_BYTES, RMRFL_NONE);
+	if (rmr_ctx == NULL) {
+		fprintf(stderr, "unable to initialize RMR on port %s\n", opts.port.c_str());
+		return 1;
+	}
+	while (!rmr_ready(rmr_ctx) && !stop_requested) {
+		fprintf(stderr, "waiting for the RMR route table\n");
+		sleep(1);
+	}
+
+	load_stats stats;
+	stats.latencies.reserve(opts.rate > 0 ? (size_t) (opts.rate * opts.duration) : 1000000);
+
+	sem_t slots;
+	sem_init(&slots, 0, opts.concurrency);
+
+	std::atomic<bool> receiving(true);
+	std::thread receiver(receive_loop, rmr_ctx, std::ref(stats), &slots, std::ref(receiving));
+
+	uint64_t start = now_ns();
+	std::thread sender(send_loop, rmr_ctx, std::cref(opts), std::cref(headers), std::ref(stats), &slots);
+
+	uint64_t last_sent = 0, last_received = 0;
+	while (!stop_requested) {	// progress once per second
+		sleep(1);
+		uint64_t sent = stats.sent, received = stats.received;
+		printf("sent %lu/s  received %lu/s  in flight %ld\n", sent - last_sent, received - last_received,
+				(long) (sent - received - stats.decode_errors));
+		fflush(stdout);
+		last_sent = sent;
+		last_received = received;
+		if (now_ns() - start >= (uint64_t) opts.duration * 1000000000ULL) {
+			break;
+		}
+	}
+	sender.join();
+	double elapsed = (now_ns() - start) / 1e9;
+
+	// wait for the control requests still in flight
+	for (int i = 0; i < E2LOAD_DRAIN_TIMEOUT * 10 && stats.received + stats.decode_errors < stats.sent; i++) {
+		usleep(100000);
+	}
+	receiving = false;
+	receiver.join();
+
+	print_report(opts, stats, elapsed);
+
+	sem_destroy(&slots);
+	rmr_close(rmr_ctx);
+
+	return 0;
+}
@@ -56,16 +56,7 @@ ric_control_request::~ric_control_request(void){
 
   mdclog_write(MDCLOG_DEBUG, "Freeing E2AP Control Request object memory");
 
-  RICcontrolRequest_t *ricControl_Request  = &(initMsg->value.choice.RICcontrolRequest);
-  for(int i = 0; i < ricControl_Request->protocolIEs.list.size; i++){
-    ricControl_Request->protocolIEs.list.array[i] = 0;
-  }
-
-  if (ricControl_Request->protocolIEs.list.size > 0){
-    free(ricControl_Request->protocolIEs.list.array);
-    ricControl_Request->protocolIEs.list.size = 0;
-    ricControl_Request->protocolIEs.list.count = 0;
-  }
+  reset();
 
   free(IE_array);
   free(initMsg);
@@ -77,8 +68,37 @@ ric_control_request::~ric_control_request(void){
 }
 
 
+/*
+  Releases the protocol IE list of the last asn1c encoding, so that the object can be reused.
+  The IEs belong to IE_array, hence only the list array grown by ASN_SEQUENCE_ADD is released,
+  and it must be done while the allocator that grew it is still current.
+*/
+void ric_control_request::reset(void){
+  RICcontrolRequest_t *ricControl_Request  = &(initMsg->value.choice.RICcontrolRequest);
+  ricControl_Request->protocolIEs.list.count = 0;
+  asn_sequence_empty(&ricControl_Request->protocolIEs.list);
+}
+
+// When buf is too small, returns false and sets size to the required buffer size
 bool ric_control_request::encode_e2ap_control_request(unsigned char *buf, ssize_t *size, ric_control_helper & dinput){
 
+  if (!fast_encoding || !fast_encodable(dinput)) {
+    return encode_asn1c(buf, size, dinput);  // also reports values out of their constraints
+  }
+
+  if (!encode_fast(buf, size, dinput)) {
+    return false;
+  }
+
+  if (mdclog_level_get() >= MDCLOG_DEBUG) {
+    return check_fast_encoding(buf, *size, dinput);
+  }
+
+  return true;
+}
+
+bool ric_control_request::encode_asn1c(unsigned char *buf, ssize_t *size, ric_control_helper & dinput){
+
   initMsg->procedureCode = ProcedureCode_id_RICcontrol;
   initMsg->criticality = Criticality_reject;
   initMsg->value.present = InitiatingMessage__value_PR_RICcontrolRequest;
@@ -112,6 +132,7 @@ bool ric_control_request::encode_e2ap_control_request(unsigned char *buf, ssize_
       std::stringstream ss;
       ss  <<"Error encoding E2AP Control Request. Reason =  encoded pdu size " << retval.encoded << " exceeds buffer size " << *size << std::endl;
       error_string = ss.str();
+      *size = retval.encoded;	// lets the caller retry with a large enough buffer
       return false;
     }
   }
@@ -212,6 +233,158 @@ bool ric_control_request::set_fields(InitiatingMessage_t *initMsg, ric_control_h
 
 
 
+/*
+  Fast path for the only PDU the xapp sends on every indication. The aligned PER layout of a
+  RICcontrolRequest with the IEs added by set_fields() is fixed, so the bytes are written directly:
+
+    E2AP-PDU             0x00 (initiatingMessage), procedureCode, criticality, open type length
+    RICcontrolRequest    0x00 (no extensions), number of IEs in 2 octets
+    each IE              id in 2 octets, criticality, open type length, value
+
+  where criticality takes the 2 most significant bits of its octet, and every length
+  determinant below 16384 takes 1 octet when shorter than 128 and 2 octets otherwise.
+*/
+
+static inline size_t aper_length_size(size_t length) {
+  return length < 128 ? 1 : 2;
+}
+
+static inline unsigned char *aper_put_length(unsigned char *p, size_t length) {
+  if (length < 128) {
+    *p++ = (unsigned char) length;
+  } else {
+    *p++ = 0x80 | (unsigned char) (length >> 8);
+    *p++ = (unsigned char) (length & 0xff);
+  }
+  return p;
+}
+
+static inline unsigned char *aper_put_u16(unsigned char *p, unsigned long value) {
+  *p++ = (unsigned char) (value >> 8);
+  *p++ = (unsigned char) (value & 0xff);
+  return p;
+}
+
+// Encoded size of an unconstrained OCTET STRING
+static inline size_t aper_octet_string_size(size_t length) {
+  return aper_length_size(length) + length;
+}
+
+static inline unsigned char *aper_put_octet_string(unsigned char *p, const unsigned char *buf, size_t length) {
+  p = aper_put_length(p, length);
+  memcpy(p, buf, length);
+  return p + length;
+}
+
+// Encoded size of a protocol IE carrying a value of the given size
+static inline size_t aper_ie_size(size_t value_size) {
+  return 2 + 1 + aper_length_size(value_size) + value_size;
+}
+
+static inline unsigned char *aper_put_ie_header(unsigned char *p, long id, long criticality, size_t value_size) {
+  p = aper_put_u16(p, id);
+  *p++ = (unsigned char) (criticality << 6);
+  return aper_put_length(p, value_size);
+}
+
+// The fast path covers values within their constraints and PDUs that need no length fragmentation
+bool ric_control_request::fast_encodable(ric_control_helper &dinput){
+  if (dinput.requestor_id < 0 || dinput.requestor_id > 65535 ||
+      dinput.instance_id < 0 || dinput.instance_id > 65535 ||
+      dinput.func_id < 0 || dinput.func_id > 4095 ||
+      dinput.control_ack > RICcontrolAckRequest_ack) {
+    return false;
+  }
+
+  return dinput.control_header_size + dinput.control_msg_size + dinput.call_process_id_size < CONTROL_REQUEST_FAST_MAX_SIZE - 64;
+}
+
+bool ric_control_request::encode_fast(unsigned char *buf, ssize_t *size, ric_control_helper &dinput){
+  size_t header_size = aper_octet_string_size(dinput.control_header_size);
+  size_t msg_size = aper_octet_string_size(dinput.control_msg_size);
+  size_t call_process_id_size = aper_octet_string_size(dinput.call_process_id_size);
+  long num_ies = 4;
+
+  size_t ies_size = aper_ie_size(5) + aper_ie_size(2) + aper_ie_size(header_size) + aper_ie_size(msg_size);
+  if (dinput.control_ack >= 0) {
+    ies_size += aper_ie_size(1);
+    num_ies++;
+  }
+  if (dinput.call_process_id_size > 0) {
+    ies_size += aper_ie_size(call_process_id_size);
+    num_ies++;
+  }
+
+  size_t request_size = 1 + 2 + ies_size;
+  size_t pdu_size = 3 + aper_length_size(request_size) + request_size;
+
+  if (*size < (ssize_t) pdu_size) {
+    std::stringstream ss;
+    ss  <<"Error encoding E2AP Control Request. Reason =  encoded pdu size " << pdu_size << " exceeds buffer size " << *size << std::endl;
+    error_string = ss.str();
+    *size = pdu_size; // lets the caller retry with a large enough buffer
+    return false;
+  }
+
+  unsigned char *p = buf;
+
+  *p++ = 0x00;  // initiatingMessage
+  *p++ = (unsigned char) ProcedureCode_id_RICcontrol;
+  *p++ = (unsigned char) (Criticality_reject << 6);
+  p = aper_put_length(p, request_size);
+
+  *p++ = 0x00;  // no extensions
+  p = aper_put_u16(p, num_ies);
+
+  p = aper_put_ie_header(p, ProtocolIE_ID_id_RICrequestID, Criticality_reject, 5);
+  *p++ = 0x00;  // no extensions
+  p = aper_put_u16(p, dinput.requestor_id);
+  p = aper_put_u16(p, dinput.instance_id);
+
+  p = aper_put_ie_header(p, ProtocolIE_ID_id_RANfunctionID, Criticality_reject, 2);
+  p = aper_put_u16(p, dinput.func_id);
+
+  p = aper_put_ie_header(p, ProtocolIE_ID_id_RICcontrolHeader, Criticality_reject, header_size);
+  p = aper_put_octet_string(p, dinput.control_header, dinput.control_header_size);
+
+  p = aper_put_ie_header(p, ProtocolIE_ID_id_RICcontrolMessage, Criticality_reject, msg_size);
+  p = aper_put_octet_string(p, dinput.control_msg, dinput.control_msg_size);
+
+  if (dinput.control_ack >= 0) {
+    p = aper_put_ie_header(p, ProtocolIE_ID_id_RICcontrolAckRequest, Criticality_reject, 1);
+    *p++ = (unsigned char) (dinput.control_ack << 6);  // extension bit, then the root value
+  }
+
+  if (dinput.call_process_id_size > 0) {
+    p = aper_put_ie_header(p, ProtocolIE_ID_id_RICcallProcessID, Criticality_reject, call_process_id_size);
+    p = aper_put_octet_string(p, dinput.call_process_id, dinput.call_process_id_size);
+  }
+
+  assert((size_t) (p - buf) == pdu_size);
+  *size = pdu_size;
+
+  return true;
+}
+
+// Debug aid: compares the fast path output with the asn1c encoding of the same request
+bool ric_control_request::check_fast_encoding(unsigned char *buf, ssize_t size, ric_control_helper &dinput){
+  std::vector<unsigned char> expected(size);
+  ssize_t expected_size = size;
+
+  if (!encode_asn1c(expected.data(), &expected_size, dinput)) {
+    mdclog_write(MDCLOG_ERR, "Unable to check fast E2AP Control Request encoding. Reason = %s", error_string.c_str());
+    return false;
+  }
+
+  if (expected_size != size || memcmp(expected.data(), buf, size) != 0) {
+    error_string = "Fast E2AP Control Request encoding differs from asn1c";
+    mdclog_write(MDCLOG_ERR, "%s (%ld bytes, asn1c %ld bytes)", error_string.c_str(), size, expected_size);
+    return false;
+  }
+
+  return true;
+}
+
 bool ric_control_request:: get_fields(InitiatingMessage_t * init_msg,  ric_control_helper &dout)
 {
   if (init_msg == 0){
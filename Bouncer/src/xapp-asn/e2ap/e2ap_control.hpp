@@ -31,6 +31,7 @@
 #include <errno.h>
 #include <mdclog/mdclog.h>
 #include <sstream>
+#include <vector>
 #include <E2AP-PDU.h>
 #include <InitiatingMessage.h>
 #include <RICcontrolRequest.h>
@@ -38,6 +39,7 @@
 #include "e2ap_control_helper.hpp"
 
 #define NUM_CONTROL_REQUEST_IES 6
+#define CONTROL_REQUEST_FAST_MAX_SIZE 16383 // longest open type the fast encoder writes without fragmentation
 
 
 class ric_control_request{
@@ -51,7 +53,20 @@ public:
   bool set_fields(InitiatingMessage_t *, ric_control_helper &);
   bool get_fields(InitiatingMessage_t *, ric_control_helper &);
   std::string get_error(void) const {return error_string ; };
+
+  void reset(void);
+
+  // Writes the APER bytes directly instead of walking the asn1c tables, see encode_fast()
+  void set_fast_encoding(bool enable) { fast_encoding = enable; };
+  bool get_fast_encoding(void) const { return fast_encoding; };
+
 private:
+  bool encode_asn1c(unsigned char *, ssize_t *, ric_control_helper &);
+  bool encode_fast(unsigned char *, ssize_t *, ric_control_helper &);
+  bool fast_encodable(ric_control_helper &);
+  bool check_fast_encoding(unsigned char *, ssize_t, ric_control_helper &);
+
+  bool fast_encoding = false;
 
   E2AP_PDU_t * e2ap_pdu_obj;
   InitiatingMessage_t *initMsg;
@@ -224,6 +224,9 @@ bool ric_control_response::set_fields(SuccessfulOutcome_t *successMsg, ric_contr
 	// ies_ric_cause->value.choice.RICcontrolStatus = dinput.control_status; // should be RicControlOutcome
 	//ASN_SEQUENCE_ADD(&(ric_acknowledge->protocolIEs), ies_ric_cause);
 
+	// the list holds all the IEs of IE_array, only those set above are encoded
+	successMsg->value.choice.RICcontrolAcknowledge.protocolIEs.list.count = ie_index + 1;
+
 	return true;
 
 };
@@ -308,6 +311,10 @@ bool ric_control_response::set_fields(UnsuccessfulOutcome_t *unsuccessMsg, ric_c
 	}
 
 	//ASN_SEQUENCE_ADD(&(ric_failure->protocolIEs), ies_ric_cause);
+
+	// the list holds all the IEs of IE_failure_array, only those set above are encoded
+	unsuccessMsg->value.choice.RICcontrolFailure.protocolIEs.list.count = ie_index + 1;
+
 	return true;
 
 };
@@ -58,16 +58,17 @@ ric_indication::ric_indication(void){
 ric_indication::~ric_indication(void){
 
   mdclog_write(MDCLOG_DEBUG, "Freeing E2AP Indication object memory");
-  // RICindication_t *ricIndication  = &(initMsg->value.choice.RICindication);
-  // for(int i = 0; i < ricIndication->protocolIEs.list.size; i++){
-  //   ricIndication->protocolIEs.list.array[i] = 0;
-  // }
-  // if (ricIndication->protocolIEs.list.size > 0){
-  //   free(ricIndication->protocolIEs.list.array);
-  //   ricIndication->protocolIEs.list.array = 0;
-  //   ricIndication->protocolIEs.list.count = 0;
-  //   ricIndication->protocolIEs.list.size = 0;
-  // }
+  // the IEs of the last encoding belong to IE_array, and their octet strings to the caller
+  RICindication_t *ricIndication  = &(initMsg->value.choice.RICindication);
+  for(int i = 0; i < ricIndication->protocolIEs.list.size; i++){
+    ricIndication->protocolIEs.list.array[i] = 0;
+  }
+  if (ricIndication->protocolIEs.list.size > 0){
+    free(ricIndication->protocolIEs.list.array);
+    ricIndication->protocolIEs.list.array = 0;
+    ricIndication->protocolIEs.list.count = 0;
+    ricIndication->protocolIEs.list.size = 0;
+  }
 
   free(IE_array);
   ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, e2ap_pdu_obj);
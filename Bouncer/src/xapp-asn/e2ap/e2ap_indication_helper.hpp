@@ -55,28 +55,6 @@ struct ric_indication_helper{
   RICindicationHeader_t indication_header;
   RICindicationMessage_t indication_msg;
 
-  UEID_t *get_ui_id() {
-    E2SM_RC_IndicationHeader_t *header = (E2SM_RC_IndicationHeader_t *) calloc(1, sizeof(E2SM_RC_IndicationHeader_t));
-    asn_transfer_syntax syntax = ATS_ALIGNED_BASIC_PER;
-    asn_dec_rval_t rval = asn_decode(NULL, syntax, &asn_DEF_UEID, (void **)&header, indication_header.buf, indication_header.size);
-    if (rval.code != RC_OK) {
-      fprintf(stderr, "ERROR %s:%d unable to decode UEID from indication header\n", __FILE__, __LINE__);
-      return nullptr;
-    }
-
-    UEID_t *ueid = (UEID_t *) calloc(1, sizeof(UEID_t));
-    // shalow copy, but we set the source to NULL to avoid freeing the memory from UEID_t in the indication header struct
-    memcpy(ueid, &header->ric_indicationHeader_formats.choice.indicationHeader_Format2->ueID, sizeof(UEID_t));
-
-    // all the choice fields are pointers, so we can just set any of them to NULL and present to nothing;
-    header->ric_indicationHeader_formats.choice.indicationHeader_Format2->ueID.choice.gNB_UEID = NULL;
-    header->ric_indicationHeader_formats.choice.indicationHeader_Format2->ueID.present = UEID_PR_NOTHING;
-
-    ASN_STRUCT_FREE(asn_DEF_E2SM_RC_IndicationHeader, header);
-
-    return ueid;
-  }
-
   E2SM_RC_IndicationMessage_Format5_t *get_indication_msg_fmt5() {
     E2SM_RC_IndicationMessage_t *msg = (E2SM_RC_IndicationMessage_t *) calloc(1, sizeof(E2SM_RC_IndicationMessage_t));
 
@@ -0,0 +1,286 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+/*
+ * e2ap_indication_view.cc
+ *
+ * Zero-copy access to the IEs of an APER encoded RIC Indication
+ */
+
+#include "e2ap_indication_view.hpp"
+
+/*
+  Reads an aligned PER length determinant at *pos, only the single and two octet forms
+  (lengths below 16384) are accepted.
+*/
+static inline bool aper_get_length(const uint8_t *buf, size_t end, size_t *pos, size_t *length) {
+  if (*pos >= end) {
+    return false;
+  }
+
+  uint8_t first = buf[*pos];
+  if ((first & 0x80) == 0) {
+    *length = first;
+    *pos += 1;
+    return true;
+  }
+  if ((first & 0xc0) == 0x80 && *pos + 1 < end) {
+    *length = ((size_t) (first & 0x3f) << 8) | buf[*pos + 1];
+    *pos += 2;
+    return true;
+  }
+
+  return false;  // fragmented
+}
+
+static inline unsigned long aper_get_u16(const uint8_t *buf) {
+  return ((unsigned long) buf[0] << 8) | buf[1];
+}
+
+// Criticality ::= ENUMERATED { reject, ignore, notify }, in the two leading bits of the octet
+static inline bool aper_valid_criticality(uint8_t octet) {
+  return (octet >> 6) <= Criticality_notify;
+}
+
+// asn1c fails the whole PDU on an IE id outside the RICindication IEs
+static inline bool indication_ie_id(unsigned long id) {
+  switch (id) {
+    case ProtocolIE_ID_id_RICrequestID:
+    case ProtocolIE_ID_id_RANfunctionID:
+    case ProtocolIE_ID_id_RICactionID:
+    case ProtocolIE_ID_id_RICindicationSN:
+    case ProtocolIE_ID_id_RICindicationType:
+    case ProtocolIE_ID_id_RICindicationHeader:
+    case ProtocolIE_ID_id_RICindicationMessage:
+    case ProtocolIE_ID_id_RICcallProcessID:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*
+  The layout walked here is the one asn1c writes for a RICindication:
+
+    E2AP-PDU             0x00 (initiatingMessage), procedureCode, criticality, open type length
+    RICindication        0x00 (no extensions), number of IEs in 2 octets
+    each IE              id in 2 octets, criticality, open type length, value
+*/
+bool IndicationView::parse(const uint8_t *buf, size_t len) {
+  size_t pos = 3;
+  size_t length;
+
+  _buf = buf;
+  _len = len;
+  _num_ies = 0;
+
+  if (buf == NULL || len < 3 || buf[0] != 0x00 || buf[1] != ProcedureCode_id_RICindication) {
+    error_string = "not a RIC Indication initiating message";
+    return false;
+  }
+  if (!aper_valid_criticality(buf[2])) {
+    error_string = "invalid RIC Indication criticality";
+    return false;
+  }
+
+  if (!aper_get_length(buf, len, &pos, &length) || pos + length > len) {
+    error_string = "invalid RIC Indication length";
+    return false;
+  }
+  size_t end = pos + length;
+
+  if (pos + 3 > end || (buf[pos] & 0x80) != 0) {
+    error_string = "RIC Indication has extensions";
+    return false;
+  }
+  unsigned long count = aper_get_u16(&buf[pos + 1]);
+  pos += 3;
+
+  if (count > INDICATION_VIEW_MAX_IES) {
+    error_string = "too many IEs in RIC Indication";
+    return false;
+  }
+
+  for (unsigned long i = 0; i < count; i++) {
+    if (pos + 3 > end) {
+      error_string = "truncated RIC Indication IE";
+      return false;
+    }
+    ie_ref &ie = _ies[_num_ies++];
+    ie.id = aper_get_u16(&buf[pos]);
+    if (!indication_ie_id(ie.id) || !aper_valid_criticality(buf[pos + 2])) {
+      error_string = "invalid RIC Indication IE";
+      return false;
+    }
+    // a repeated IE would be taken from its last occurrence by get_fields() of the full decode
+    for (int j = 0; j < _num_ies - 1; j++) {
+      if (_ies[j].id == ie.id) {
+        error_string = "repeated RIC Indication IE";
+        return false;
+      }
+    }
+    pos += 3;  // id and criticality
+
+    if (!aper_get_length(buf, end, &pos, &ie.size) || pos + ie.size > end) {
+      error_string = "invalid RIC Indication IE length";
+      return false;
+    }
+    ie.offset = pos;
+    pos += ie.size;
+  }
+
+  if (pos != end) {
+    error_string = "trailing bytes in RIC Indication";
+    return false;
+  }
+
+  return true;
+}
+
+bool IndicationView::get_ie(long id, const uint8_t *&value, size_t &size) const {
+  for (int i = 0; i < _num_ies; i++) {
+    if (_ies[i].id == id) {
+      value = _buf + _ies[i].offset;
+      size = _ies[i].size;
+      return true;
+    }
+  }
+  return false;
+}
+
+// RICrequestID ::= SEQUENCE { ricRequestorID INTEGER (0..65535), ricInstanceID INTEGER (0..65535), ... }
+bool IndicationView::get_request_id(long &requestor_id, long &instance_id) const {
+  const uint8_t *value;
+  size_t size;
+
+  if (!get_ie(ProtocolIE_ID_id_RICrequestID, value, size) || size != 5 || (value[0] & 0x80) != 0) {
+    return false;
+  }
+  requestor_id = aper_get_u16(&value[1]);
+  instance_id = aper_get_u16(&value[3]);
+
+  return true;
+}
+
+// RANfunctionID ::= INTEGER (0..4095)
+bool IndicationView::get_function_id(long &func_id) const {
+  const uint8_t *value;
+  size_t size;
+
+  if (!get_ie(ProtocolIE_ID_id_RANfunctionID, value, size) || size != 2) {
+    return false;
+  }
+  func_id = aper_get_u16(value);
+
+  return func_id <= 4095;
+}
+
+// RICactionID ::= INTEGER (0..255)
+bool IndicationView::get_action_id(long &action_id) const {
+  const uint8_t *value;
+  size_t size;
+
+  if (!get_ie(ProtocolIE_ID_id_RICactionID, value, size) || size != 1) {
+    return false;
+  }
+  action_id = value[0];
+
+  return true;
+}
+
+// RICindicationType ::= ENUMERATED { report, insert, ... }
+bool IndicationView::get_indication_type(long &indication_type) const {
+  const uint8_t *value;
+  size_t size;
+
+  if (!get_ie(ProtocolIE_ID_id_RICindicationType, value, size) || size != 1 || (value[0] & 0x80) != 0) {
+    return false;
+  }
+  indication_type = (value[0] >> 6) & 0x01;
+
+  return true;
+}
+
+// Unconstrained OCTET STRING: a length determinant followed by the octets
+bool IndicationView::get_octet_string(long id, const uint8_t *&buf, size_t &size) const {
+  const uint8_t *value;
+  size_t value_size;
+  size_t pos = 0;
+
+  if (!get_ie(id, value, value_size) || !aper_get_length(value, value_size, &pos, &size) || pos + size != value_size) {
+    return false;
+  }
+  buf = value + pos;
+
+  return true;
+}
+
+bool IndicationView::get_call_process_id(const uint8_t *&buf, size_t &size) const {
+  return get_octet_string(ProtocolIE_ID_id_RICcallProcessID, buf, size);
+}
+
+bool IndicationView::get_indication_header(const uint8_t *&buf, size_t &size) const {
+  return get_octet_string(ProtocolIE_ID_id_RICindicationHeader, buf, size);
+}
+
+bool IndicationView::get_indication_message(const uint8_t *&buf, size_t &size) const {
+  return get_octet_string(ProtocolIE_ID_id_RICindicationMessage, buf, size);
+}
+
+bool IndicationView::get_fields(ric_indication_helper &dout) const {
+  const uint8_t *buf;
+  size_t size;
+
+  if (!get_request_id(dout.request_id.ricRequestorID, dout.request_id.ricInstanceID) ||
+      !get_function_id(dout.func_id) ||
+      !get_action_id(dout.action_id) ||
+      !get_indication_type(dout.indication_type)) {
+    return false;
+  }
+
+  if (!get_indication_header(buf, size)) {
+    return false;
+  }
+  dout.indication_header.buf = (uint8_t *) buf;
+  dout.indication_header.size = size;
+
+  if (!get_indication_message(buf, size)) {
+    return false;
+  }
+  dout.indication_msg.buf = (uint8_t *) buf;
+  dout.indication_msg.size = size;
+
+  // optional IEs, which must be well formed when present
+  const uint8_t *value;
+  if (get_ie(ProtocolIE_ID_id_RICcallProcessID, value, size)) {
+    if (!get_call_process_id(buf, size)) {
+      return false;
+    }
+    dout.call_process_id.buf = (uint8_t *) buf;
+    dout.call_process_id.size = size;
+  }
+
+  if (get_ie(ProtocolIE_ID_id_RICindicationSN, value, size)) {
+    if (size != 2) {
+      return false;
+    }
+    dout.indication_sn = aper_get_u16(value);  // INTEGER (0..65535)
+  }
+
+  return true;
+}
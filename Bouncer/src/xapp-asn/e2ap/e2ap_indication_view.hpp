@@ -0,0 +1,83 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+/*
+ * e2ap_indication_view.hpp
+ *
+ * Zero-copy access to the IEs of an APER encoded RIC Indication
+ */
+
+#ifndef E2AP_INDICATION_VIEW_H_
+#define E2AP_INDICATION_VIEW_H_
+
+#include <stdint.h>
+#include <string>
+#include <ProcedureCode.h>
+#include <ProtocolIE-ID.h>
+#include <ProtocolIE-Field.h>
+#include "e2ap_indication_helper.hpp"
+
+#define INDICATION_VIEW_MAX_IES 16
+
+/*
+  Walks the protocol-IE container of a RIC Indication once and keeps the offset and length
+  of each IE value in the buffer, without allocating or copying anything. Values are only
+  decoded when a getter is called, and all pointers handed out point into the buffer.
+
+  Only the plain encoding is understood (no extensions, no fragmented lengths, no
+  unknown or repeated IEs), so parse() and the getters return false for anything else
+  and the caller is expected to fall back to the full asn1c decode in that case.
+*/
+class IndicationView {
+public:
+  IndicationView(): _buf(NULL), _len(0), _num_ies(0) {};
+
+  bool parse(const uint8_t *buf, size_t len);
+
+  bool get_ie(long id, const uint8_t *&value, size_t &size) const;
+
+  bool get_request_id(long &requestor_id, long &instance_id) const;
+  bool get_function_id(long &func_id) const;
+  bool get_action_id(long &action_id) const;
+  bool get_indication_type(long &indication_type) const;
+  bool get_call_process_id(const uint8_t *&buf, size_t &size) const;
+  bool get_indication_header(const uint8_t *&buf, size_t &size) const;
+  bool get_indication_message(const uint8_t *&buf, size_t &size) const;
+
+  // Fills the helper like ric_indication::get_fields(), octet strings point into the buffer
+  bool get_fields(ric_indication_helper &dout) const;
+
+  std::string get_error(void) const { return error_string; };
+
+private:
+  struct ie_ref {
+    long id;
+    size_t offset;  // of the value, right after its open type length
+    size_t size;
+  };
+
+  bool get_octet_string(long id, const uint8_t *&buf, size_t &size) const;
+
+  const uint8_t *_buf;
+  size_t _len;
+  ie_ref _ies[INDICATION_VIEW_MAX_IES];
+  int _num_ies;
+  std::string error_string;
+};
+
+#endif /* E2AP_INDICATION_VIEW_H_ */
@@ -124,7 +124,7 @@ bool subscription_delete::set_fields( subscription_helper &helper )
  	ies_ricreq->value.present = RICsubscriptionDeleteRequest_IEs__value_PR_RICrequestID;
  	RICrequestID_t *ricrequest_ie = &ies_ricreq->value.choice.RICrequestID;
   ricrequest_ie->ricRequestorID = helper.get_request_id().ricRequestorID;
- 	update_instance++;//incrementing ricInstanceID by one, each time the bouncer send delete req
+ 	update_instance = update_instance % 65535 + 1;//incrementing ricInstanceID by one, each time the bouncer send delete req, within its 1..65535 range
  	ricrequest_ie->ricInstanceID = update_instance;
  	mdclog_write(MDCLOG_INFO,"instance id for subsdelreq  = %ld", update_instance);
 
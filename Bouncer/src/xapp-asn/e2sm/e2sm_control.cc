@@ -29,6 +29,7 @@
 #include "RANParameter-Value.h"
 #include "NR-CGI.h"
 #include "UEID-GNB.h"
+#include "asn_internal.h"	// CALLOC, so that control headers come from the indication arena like the rest of asn1c
 
  //initialize
  e2sm_control::e2sm_control(void){
@@ -66,6 +67,15 @@
 
 };
 
+/*
+  Releases what the last E2SM RC encoding left in the control header and message,
+  while the allocator that was current during the encoding is still current.
+*/
+void e2sm_control::reset(void) {
+  ASN_STRUCT_RESET(asn_DEF_E2SM_RC_ControlHeader, rc_control_header);
+  ASN_STRUCT_RESET(asn_DEF_E2SM_RC_ControlMessage, rc_control_msg);
+}
+
 bool e2sm_control::encode_control_header(unsigned char *buf, ssize_t *size, e2sm_control_helper &helper){
 
   ASN_STRUCT_RESET(asn_DEF_E2SM_Bouncer_ControlHeader, control_head);
@@ -201,6 +211,7 @@ bool e2sm_control::get_fields(E2SM_Bouncer_ControlMessage_t * ref_control_messag
 	  return true;
   }
 
+// The UEID is only borrowed by the header, and is detached from it once encoded
 bool e2sm_control::encode_rc_control_header(unsigned char *buf, ssize_t *size, UEID_t *ueid) {
   bool res = set_fields(rc_control_header, ueid);
   if (!res){
@@ -208,18 +219,25 @@ bool e2sm_control::encode_rc_control_header(unsigned char *buf, ssize_t *size, U
   }
 
   int ret_constr = asn_check_constraints(&asn_DEF_E2SM_RC_ControlHeader, rc_control_header, errbuf, &errbuf_len);
-  if(ret_constr){
-    error_string.assign(&errbuf[0], errbuf_len);
-    return false;
-  }
 
-  if (mdclog_level_get() > MDCLOG_INFO) {
+  if (!ret_constr && mdclog_level_get() > MDCLOG_INFO) {
     xer_fprint(stderr, &asn_DEF_E2SM_RC_ControlHeader, rc_control_header);
   }
 
-  asn_enc_rval_t retval = asn_encode_to_buffer(0, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2SM_RC_ControlHeader, rc_control_header, buf, *size);
+  asn_enc_rval_t retval = {-1, 0, 0};
+  if (!ret_constr) {
+    retval = asn_encode_to_buffer(0, ATS_ALIGNED_BASIC_PER, &asn_DEF_E2SM_RC_ControlHeader, rc_control_header, buf, *size);
+  }
 
-  if(retval.encoded == -1){
+  if (ueid != NULL) {
+    memset(&rc_control_header->ric_controlHeader_formats.choice.controlHeader_Format1->ueID, 0, sizeof(UEID_t));
+  }
+
+  if(ret_constr){
+    error_string.assign(&errbuf[0], errbuf_len);
+    return false;
+  }
+  else if(retval.encoded == -1){
     error_string.assign(strerror(errno));
     return false;
   }
@@ -236,9 +254,81 @@ bool e2sm_control::encode_rc_control_header(unsigned char *buf, ssize_t *size, U
   return true;
 }
 
-bool e2sm_control::encode_rc_control_message(unsigned char *buf, ssize_t *size) {
+/*
+  Encodes the header for the UEID of an indication. The APER encoded UEID is copied verbatim
+  from the indication header when possible, and ueid is encoded by asn1c otherwise.
+*/
+bool e2sm_control::encode_rc_control_header(unsigned char *buf, ssize_t *size, const e2sm_rc_ueid_ref &ue, UEID_t *ueid) {
+  // asn1c is used when debugging, so that the header gets printed
+  if (mdclog_level_get() <= MDCLOG_INFO && splice_rc_control_header(buf, size, ue)) {
+    return true;
+  }
+
+  return encode_rc_control_header(buf, size, ueid);
+}
+
+/*
+  Control header Format1 around the UEID bits of the indication header:
+
+    bit 0     extension bit of the header, the formats choice has a single root alternative
+    bit 1     extension bit of the formats choice
+    bit 2     extension bit of Format1
+    bit 3     presence of ric-ControlDecision
+    bit 4     ueID as encoded in the indication header, followed by the aligned
+              ric-Style-Type and ric-ControlAction-ID, and by ric-ControlDecision
+
+  Alignment padding inside the UEID is relative to the start of the PDU it is encoded in,
+  so the bits can only be copied when the UEID starts 4 bits into an octet in the indication
+  header as well, as it does in indication header Format2.
+*/
+bool e2sm_control::splice_rc_control_header(unsigned char *buf, ssize_t *size, const e2sm_rc_ueid_ref &ue) {
+  if (ue.buf == NULL || ue.bit_length == 0 || (ue.bit_offset & 7) != 4 || buf == NULL) {
+    return false;
+  }
+
+  size_t ueid_size = (4 + ue.bit_length + 7) / 8;  // octets holding the header bits and the UEID
+  if ((ssize_t) ueid_size + 16 > *size) {
+    return false;
+  }
+
+  const unsigned char *ueid_buf = ue.buf + ue.bit_offset / 8;
+  memcpy(buf, ueid_buf, ueid_size);
+  buf[0] = 0x10 | (buf[0] & 0x0f);
+  size_t end = (4 + ue.bit_length) & 7;
+  if (end) {
+    buf[ueid_size - 1] &= (unsigned char) (0xff << (8 - end));  // drop what follows the UEID in the indication
+  }
+
+  unsigned char *p = buf + ueid_size;
+
+  // ric-Style-Type ::= INTEGER, a length and the value in as few octets as it fits
+  long style = E2SM_RC_CONTROL_STYLE_TYPE;
+  unsigned char style_size = 1;
+  while (style_size < sizeof(long) && (style >> (8 * style_size - 1)) != 0) {
+    style_size++;
+  }
+  *p++ = style_size;
+  for (int i = style_size - 1; i >= 0; i--) {
+    *p++ = (unsigned char) (style >> (8 * i));
+  }
+
+  // ric-ControlAction-ID ::= INTEGER (1..65535, ...), extension bit then the aligned offset from 1
+  long action = E2SM_RC_CONTROL_ACTION_ID - 1;
+  *p++ = 0;
+  *p++ = (unsigned char) (action >> 8);
+  *p++ = (unsigned char) (action & 0xff);
+
+  // ric-ControlDecision ::= ENUMERATED {accept, reject, ...}
+  *p++ = (unsigned char) (E2SM_RC_ControlHeader_Format1__ric_ControlDecision_accept << 6);
+
+  *size = p - buf;
+
+  return true;
+}
+
+bool e2sm_control::encode_rc_control_message(unsigned char *buf, ssize_t *size, const char *plmnid, unsigned long nr_cell_id) {
   bool res;
-  res = set_fields(rc_control_msg);
+  res = set_fields(rc_control_msg, plmnid, nr_cell_id);
   if (!res){
     return false;
   }
@@ -291,7 +381,7 @@ bool e2sm_control::set_fields(E2SM_RC_ControlHeader_t *control_header, UEID_t *u
   return true;
 }
 
-bool e2sm_control::set_fields(E2SM_RC_ControlMessage_t *control_msg) {
+bool e2sm_control::set_fields(E2SM_RC_ControlMessage_t *control_msg, const char *plmnid, unsigned long nr_cell_id) {
   if(control_msg == 0){
     error_string = "Invalid reference for E2SM_RC_ControlMessage set fields";
     return false;
@@ -299,7 +389,7 @@ bool e2sm_control::set_fields(E2SM_RC_ControlMessage_t *control_msg) {
 
   ASN_STRUCT_RESET(asn_DEF_E2SM_RC_ControlMessage, rc_control_msg);
 
-  E2SM_RC_ControlMessage_Format1_t *ctrlmsg_fmt1 = generate_e2sm_rc_control_msg_format1();
+  E2SM_RC_ControlMessage_Format1_t *ctrlmsg_fmt1 = generate_e2sm_rc_control_msg_format1(plmnid, nr_cell_id);
   if(ctrlmsg_fmt1 == NULL) {
     return false; // error string is set on called function
   }
@@ -311,18 +401,24 @@ bool e2sm_control::set_fields(E2SM_RC_ControlMessage_t *control_msg) {
 }
 
 E2SM_RC_ControlHeader_Format1_t *e2sm_control::generate_e2sm_rc_control_header_format1(UEID_t *ueid) {
-  // TODO we should populate this using the corresponding values from indication request
-  E2SM_RC_ControlHeader_Format1_t *ctrlhead_fmt1 = (E2SM_RC_ControlHeader_Format1_t *) calloc(1, sizeof(E2SM_RC_ControlHeader_Format1_t));
+  E2SM_RC_ControlHeader_Format1_t *ctrlhead_fmt1 = (E2SM_RC_ControlHeader_Format1_t *) CALLOC(1, sizeof(E2SM_RC_ControlHeader_Format1_t));
   if(ctrlhead_fmt1 == NULL) {
     error_string = "unable to alloc E2SM_RC_ControlHeader_Format1 for generating control header";
     return NULL;
   }
-  generate_e2sm_rc_ueid(&ctrlhead_fmt1->ueID);  // TODO this should be the corresponding UE from insert message
-  ctrlhead_fmt1->ric_Style_Type = 4; // Radio access control
-  ctrlhead_fmt1->ric_ControlAction_ID = 1; // UE Admission Control
-  ctrlhead_fmt1->ric_ControlDecision = (long *) calloc(1, sizeof(long));
+  if (ueid != NULL) {
+    ctrlhead_fmt1->ueID = *ueid;  // shallow copy, detached again by encode_rc_control_header
+  } else {
+    generate_e2sm_rc_ueid(&ctrlhead_fmt1->ueID);  // the indication carried no UEID
+  }
+  ctrlhead_fmt1->ric_Style_Type = E2SM_RC_CONTROL_STYLE_TYPE;
+  ctrlhead_fmt1->ric_ControlAction_ID = E2SM_RC_CONTROL_ACTION_ID;
+  ctrlhead_fmt1->ric_ControlDecision = (long *) CALLOC(1, sizeof(long));
   if(ctrlhead_fmt1->ric_ControlDecision == NULL) {
     error_string = "unable to alloc Ric Control Decision for set fields";
+    if (ueid != NULL) {
+      memset(&ctrlhead_fmt1->ueID, 0, sizeof(UEID_t));
+    }
     ASN_STRUCT_FREE(asn_DEF_E2SM_RC_ControlHeader_Format1, ctrlhead_fmt1);
     return NULL;
   }
@@ -364,7 +460,7 @@ void e2sm_control::generate_e2sm_rc_ueid(UEID_t *ueid) {
   ueid->present = UEID_PR_gNB_UEID;
 }
 
-E2SM_RC_ControlMessage_Format1_t *e2sm_control::generate_e2sm_rc_control_msg_format1() {
+E2SM_RC_ControlMessage_Format1_t *e2sm_control::generate_e2sm_rc_control_msg_format1(const char *plmnid, unsigned long nr_cell_id) {
   E2SM_RC_ControlMessage_Format1_t *ctrlmsg_fmt1 = (E2SM_RC_ControlMessage_Format1_t *) calloc(1, sizeof(E2SM_RC_ControlMessage_Format1_t));
   if(ctrlmsg_fmt1 == NULL) {
     error_string = "unable to alloc E2SM_RC_ControlMessage_Format1 for generating control message";
@@ -430,8 +526,7 @@ E2SM_RC_ControlMessage_Format1_t *e2sm_control::generate_e2sm_rc_control_msg_for
       (RANParameter_Value_t *) calloc(1, sizeof(RANParameter_Value_t));
 
   ranp_struct_item4->ranParameter_valueType->choice.ranP_Choice_ElementFalse->ranParameter_value->present = RANParameter_Value_PR_valueOctS;
-  // we should get this information from indication request
-  OCTET_STRING_t *nr_cgi = (generate_and_encode_nr_cgi("747", 89));  // FIXME for now we use dummy values, update this with correct PLMN ID and cell id
+  OCTET_STRING_t *nr_cgi = (generate_and_encode_nr_cgi(plmnid, nr_cell_id));
   if(!nr_cgi) {
     ASN_STRUCT_FREE(asn_DEF_E2SM_RC_ControlMessage_Format1, ctrlmsg_fmt1);
     return NULL;  // error string is set on called function
@@ -502,8 +597,10 @@ OCTET_STRING_t *e2sm_control::generate_and_encode_nr_cgi(const char *plmnid, uns
     return NULL;
   }
 
-  OCTET_STRING_t *ostr = OCTET_STRING_new_fromBuf(&asn_DEF_NR_CGI, (char *) nr_cgi_buffer, retval.encoded);
-  if (!ostr) {
+  // the caller copies the struct and releases it with free(), so only the buffer may come from the asn1c allocator
+  OCTET_STRING_t *ostr = (OCTET_STRING_t *) calloc(1, sizeof(OCTET_STRING_t));
+  if (!ostr || OCTET_STRING_fromBuf(ostr, (char *) nr_cgi_buffer, retval.encoded) != 0) {
+    free(ostr);
     error_string = "unable to encode OCTET_STRING from buffer for NR CGI";
     ASN_STRUCT_FREE(asn_DEF_NR_CGI, nr_cgi);
     return NULL;
@@ -40,6 +40,15 @@
 #include <E2SM-RC-ControlHeader-Format1.h>
 #include <E2SM-RC-ControlMessage-Format1.h>
 
+#include "e2sm_ueid.hpp"
+
+// Target cell of the control message until it is taken from the indication
+#define E2SM_RC_DEFAULT_PLMN "747"
+#define E2SM_RC_DEFAULT_NR_CELL_ID 89
+
+#define E2SM_RC_CONTROL_STYLE_TYPE 4  // Radio access control
+#define E2SM_RC_CONTROL_ACTION_ID 1   // UE Admission Control
+
 class e2sm_control {
 public:
 	e2sm_control(void);
@@ -57,21 +66,26 @@ public:
 
   // E2SM RC
   bool set_fields(E2SM_RC_ControlHeader_t *control_header, UEID_t *ueid);
-  bool set_fields(E2SM_RC_ControlMessage_t *control_msg);
+  bool set_fields(E2SM_RC_ControlMessage_t *control_msg, const char *plmnid, unsigned long nr_cell_id);
 
   // bool get_fields(E2SM_RC_ControlHeader_t *control_header, e2sm_rc_control_helper &helper);
   // bool get_fields(E2SM_RC_ControlMessage_t *control_msg, e2sm_rc_control_helper &helper);
 
   bool encode_rc_control_header(unsigned char *buf, ssize_t *size, UEID_t *ueid);
-  bool encode_rc_control_message(unsigned char *buf, ssize_t *size);
+  bool encode_rc_control_header(unsigned char *buf, ssize_t *size, const e2sm_rc_ueid_ref &ue, UEID_t *ueid);
+  bool encode_rc_control_message(unsigned char *buf, ssize_t *size,
+                                 const char *plmnid = E2SM_RC_DEFAULT_PLMN, unsigned long nr_cell_id = E2SM_RC_DEFAULT_NR_CELL_ID);
 
   std::string  get_error (void) const {return error_string ;};
 
+  void reset(void);
+
 private:
   E2SM_RC_ControlHeader_Format1_t *generate_e2sm_rc_control_header_format1(UEID_t *ueid);
-  E2SM_RC_ControlMessage_Format1_t *generate_e2sm_rc_control_msg_format1();
+  E2SM_RC_ControlMessage_Format1_t *generate_e2sm_rc_control_msg_format1(const char *plmnid, unsigned long nr_cell_id);
   OCTET_STRING_t *generate_and_encode_nr_cgi(const char *plmnid, unsigned long nr_cell_id);
   void generate_e2sm_rc_ueid(UEID_t *ueid);
+  bool splice_rc_control_header(unsigned char *buf, ssize_t *size, const e2sm_rc_ueid_ref &ue);
 
   E2SM_Bouncer_ControlHeader_t * control_head; // used for encoding
   E2SM_Bouncer_ControlMessage_t* control_msg;
@@ -0,0 +1,63 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+
+
+#include "e2sm_control_cache.hpp"
+
+/*
+  Copies the encoded control message for the given target into buf, and sets size to its length.
+  On a cache miss the message is encoded straight into buf and then kept for the next request.
+*/
+bool e2sm_control_cache::get_control_message(unsigned char *buf, ssize_t *size, const char *plmnid, unsigned long nr_cell_id, long decision) {
+  if (!plmnid || strlen(plmnid) > 3) {
+    error_string = "Invalid plmnid for control message cache (max length is 3)";
+    return false;
+  }
+
+  cache_key key = {0, nr_cell_id, decision};
+  for (const char *c = plmnid; *c != '\0'; c++) {
+    key.plmnid = (key.plmnid << 8) | (uint8_t) *c;
+  }
+
+  auto it = entries.find(key);
+  if (it != entries.end()) {
+    if ((size_t) *size < it->second.size()) {
+      std::stringstream ss;
+      ss << "Error copying cached E2SM_RC_ControlMessage. Reason = encoded pdu size " << it->second.size() << " exceeds buffer size " << *size;
+      error_string = ss.str();
+      return false;
+    }
+    memcpy(buf, it->second.data(), it->second.size());
+    *size = it->second.size();
+    return true;
+  }
+
+  e2sm_control control;
+  if (!control.encode_rc_control_message(buf, size, plmnid, nr_cell_id)) {
+    error_string = control.get_error();
+    return false;
+  }
+
+  if (entries.size() < max_entries) {
+    entries.emplace(key, std::vector<uint8_t>(buf, buf + *size));
+    mdclog_write(MDCLOG_DEBUG, "Cached E2SM_RC_ControlMessage of %ld bytes for plmnid %s and nr cell id %lu", *size, plmnid, nr_cell_id);
+  }
+
+  return true;
+}
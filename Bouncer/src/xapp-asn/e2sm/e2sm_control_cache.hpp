@@ -0,0 +1,72 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+
+
+/* Cache of APER encoded E2SM-RC control messages */
+#ifndef SRC_XAPP_ASN_E2SM_E2SM_CONTROL_CACHE_HPP_
+#define SRC_XAPP_ASN_E2SM_E2SM_CONTROL_CACHE_HPP_
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "e2sm_control.hpp"
+
+#define E2SM_CONTROL_CACHE_SIZE 4096  // entries, messages of further targets are encoded every time
+
+/*
+  Indications that lead to the same target cell and control decision get the same control
+  message, so each encoding is kept and later requests for that target copy its bytes.
+  Entries are built on first use. Not thread safe, every worker keeps its own cache.
+*/
+class e2sm_control_cache {
+public:
+  e2sm_control_cache(size_t max_entries = E2SM_CONTROL_CACHE_SIZE): max_entries(max_entries) {};
+
+  bool get_control_message(unsigned char *buf, ssize_t *size, const char *plmnid, unsigned long nr_cell_id, long decision);
+
+  size_t get_size(void) const { return entries.size(); };
+  std::string get_error(void) const { return error_string; };
+
+private:
+  struct cache_key {
+    uint32_t plmnid;  // up to 3 octets
+    unsigned long nr_cell_id;
+    long decision;
+
+    bool operator==(const cache_key &other) const {
+      return plmnid == other.plmnid && nr_cell_id == other.nr_cell_id && decision == other.decision;
+    };
+  };
+
+  struct cache_key_hash {
+    size_t operator()(const cache_key &key) const {
+      size_t h = std::hash<unsigned long>()(key.nr_cell_id);
+      h ^= std::hash<uint64_t>()(((uint64_t) key.plmnid << 32) | (uint32_t) key.decision) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+      return h;
+    };
+  };
+
+  size_t max_entries;
+  std::unordered_map<cache_key, std::vector<uint8_t>, cache_key_hash> entries;
+  std::string error_string;
+};
+
+#endif /* SRC_XAPP_ASN_E2SM_E2SM_CONTROL_CACHE_HPP_ */
@@ -116,19 +116,4 @@ struct e2sm_control_helper {
 // 	UEID_t *ueid;
 // };
 
-class RCIndicationlHelper {
-	public:
-
-	E2SM_RC_IndicationHeader_t *decode_e2sm_rc_indication_header(RICindicationHeader_t *e2ap_header) {
-		E2SM_RC_IndicationHeader_t *header = NULL;
-		asn_transfer_syntax syntax = ATS_ALIGNED_BASIC_PER;
-		asn_dec_rval_t rval = asn_decode(NULL, syntax, &asn_DEF_E2SM_RC_IndicationHeader, (void **)&header, e2ap_header->buf, e2ap_header->size);
-		if (rval.code != RC_OK) {
-			fprintf(stderr, "ERROR %s:%d unable to decode UEID from indication header\n", __FILE__, __LINE__);
-			return nullptr;
-		}
-		return header;
-	}
-};
-
 #endif
@@ -0,0 +1,226 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+
+
+/* UEID extraction from E2SM-RC indication headers */
+#include "e2sm_ueid.hpp"
+
+static inline int get_bit(const uint8_t *buf, size_t bit) {
+  return (buf[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+// Octet made of the 8 bits starting at bit, zero padded past bit_end
+static inline uint8_t get_octet(const uint8_t *buf, size_t bit, size_t bit_end) {
+  size_t shift = bit & 7;
+  uint16_t v = (uint16_t) buf[bit >> 3] << 8;
+  if (shift && ((bit >> 3) + 1) * 8 < bit_end) {
+    v |= buf[(bit >> 3) + 1];
+  }
+  uint8_t octet = (uint8_t) (v >> (8 - shift));
+  if (bit + 8 > bit_end) {
+    octet &= (uint8_t) (0xff << (bit + 8 - bit_end));
+  }
+  return octet;
+}
+
+/*
+  E2SM-RC-IndicationHeader ::= SEQUENCE { CHOICE { Format1, Format2, ..., Format3 }, ... }
+
+  bit 0 is the extension bit of the header and bit 1 the one of the formats choice, followed by
+    Format1/Format2   1 bit index, then the extension bit of the format
+    Format3           1 bit extension index, then an aligned open type holding the format
+
+  The extension index is sized after the root alternatives, as asn1c encodes and decodes it.
+
+  Format2 starts with the UEID, while Format3 starts with the presence bits of its optional
+  ric-eventTriggerCondition-ID and ueID, and puts the UEID after the condition id.
+*/
+bool e2sm_rc_ueid_decoder::find_ueid(const uint8_t *header, size_t size, size_t &bit_offset, size_t &bit_limit) {
+  if (size < 1) {
+    error_string = "empty indication header";
+    return false;
+  }
+
+  bit_limit = size * 8;
+
+  if (!get_bit(header, 1)) {
+    if (!get_bit(header, 2)) {
+      error_string = "indication header Format1 carries no UEID";
+      return false;
+    }
+    bit_offset = 4;
+    return true;
+  }
+
+  if (size < 2 || get_bit(header, 2)) {
+    error_string = "unknown indication header format";
+    return false;
+  }
+
+  size_t content;
+  size_t length;
+  if ((header[1] & 0x80) == 0) {
+    length = header[1];
+    content = 2;
+  } else if ((header[1] & 0xc0) == 0x80 && size > 2) {
+    length = ((size_t) (header[1] & 0x3f) << 8) | header[2];
+    content = 3;
+  } else {
+    error_string = "invalid indication header Format3 length";
+    return false;
+  }
+  if (length == 0 || content + length > size) {
+    error_string = "truncated indication header Format3";
+    return false;
+  }
+  bit_limit = (content + length) * 8;
+
+  size_t bit = content * 8;
+  if (!get_bit(header, bit + 2)) {
+    error_string = "indication header Format3 carries no UEID";
+    return false;
+  }
+
+  if (!get_bit(header, bit + 1)) {
+    bit_offset = bit + 3;
+  } else if (!get_bit(header, bit + 3)) {
+    bit_offset = bit + 24;  // RIC-EventTriggerCondition-ID ::= INTEGER (1..65535, ...) aligned to the next octet
+  } else if (content + 1 < size && (header[content + 1] & 0x80) == 0) {
+    bit_offset = (content + 2 + header[content + 1]) * 8;  // extended value, length and octets
+  } else if (content + 2 < size && (header[content + 1] & 0xc0) == 0x80) {
+    bit_offset = (content + 3 + (((size_t) (header[content + 1] & 0x3f) << 8) | header[content + 2])) * 8;
+  } else {
+    error_string = "invalid ric-eventTriggerCondition-ID in indication header Format3";
+    return false;
+  }
+
+  if (bit_offset >= bit_limit) {
+    error_string = "truncated indication header Format3";
+    return false;
+  }
+
+  return true;
+}
+
+// Collects the canonical encoding of a UEID into its key
+struct ue_key_builder {
+  ue_key_builder(e2sm_rc_ue_key &k): key(k), hash(14695981039346656037ULL), size(0) {};
+
+  void add(uint8_t octet) {
+    if (size < E2SM_RC_UE_KEY_SIZE - 1) {
+      key.bytes[1 + size] = octet;
+    }
+    hash ^= octet;  // FNV-1a
+    hash *= 1099511628211ULL;
+    size++;
+  };
+
+  static int consume(const void *buf, size_t size, void *app_key) {
+    ue_key_builder *builder = (ue_key_builder *) app_key;
+    for (size_t i = 0; i < size; i++) {
+      builder->add(((const uint8_t *) buf)[i]);
+    }
+    return 0;
+  };
+
+  e2sm_rc_ue_key &key;
+  uint64_t hash;
+  size_t size;
+};
+
+/*
+  The key is made of the APER encoding of the UEID on its own. Alignment padding inside the
+  UEID depends on the bit offset it is encoded at, so the header bits are used as is when
+  the UEID starts on an octet, while a UEID at any other offset is encoded again for the key.
+*/
+bool e2sm_rc_ueid_decoder::make_key(e2sm_rc_ueid_ref &ref, const UEID_t *ueid) {
+  ue_key_builder builder(ref.key);
+
+  memset(&ref.key, 0, sizeof(ref.key));
+
+  if ((ref.bit_offset & 7) == 0) {
+    size_t bit_end = ref.bit_offset + ref.bit_length;
+    for (size_t bit = ref.bit_offset; bit < bit_end; bit += 8) {
+      builder.add(get_octet(ref.buf, bit, bit_end));
+    }
+  } else {
+    asn_enc_rval_t rval = aper_encode(&asn_DEF_UEID, NULL, ueid, ue_key_builder::consume, &builder);
+    if (rval.encoded < 0) {
+      error_string = "unable to encode UEID key";
+      return false;
+    }
+  }
+
+  ref.key.bytes[0] = (uint8_t) ueid->present;
+  if (builder.size > E2SM_RC_UE_KEY_SIZE - 1) {
+    ref.key.bytes[0] |= E2SM_RC_UE_KEY_HASHED;
+    for (int i = 0; i < 8; i++) {
+      ref.key.bytes[1 + i] = (uint8_t) (builder.hash >> (56 - 8 * i));
+    }
+    ref.key.bytes[9] = (uint8_t) (builder.size >> 8);
+    ref.key.bytes[10] = (uint8_t) builder.size;
+    // the last bytes still hold octets of the encoding itself
+  }
+
+  return true;
+}
+
+/*
+  Decodes the UEID of an APER encoded E2SM-RC indication header. The decoded UEID is handed
+  to the caller when ueid is given, and must be released with ASN_STRUCT_FREE.
+*/
+bool e2sm_rc_ueid_decoder::decode(const uint8_t *header, size_t size, e2sm_rc_ueid_ref &ref, UEID_t **ueid) {
+  size_t bit_offset;
+  size_t bit_limit;
+
+  if (header == NULL) {
+    error_string = "Invalid reference for indication header in UEID decode";
+    return false;
+  }
+
+  if (!find_ueid(header, size, bit_offset, bit_limit)) {
+    return false;
+  }
+
+  // alignment is relative to the first octet, so decoding starts at the octet holding the UEID
+  UEID_t *decoded = NULL;
+  size_t octet = bit_offset >> 3;
+  asn_dec_rval_t rval = aper_decode(NULL, &asn_DEF_UEID, (void **) &decoded, header + octet, bit_limit / 8 - octet, bit_offset & 7, 0);
+  if (rval.code != RC_OK) {
+    error_string = "unable to decode UEID from indication header";
+    ASN_STRUCT_FREE(asn_DEF_UEID, decoded);
+    return false;
+  }
+
+  ref.buf = header;
+  ref.bit_offset = bit_offset;
+  ref.bit_length = rval.consumed;
+  if (!make_key(ref, decoded)) {
+    ASN_STRUCT_FREE(asn_DEF_UEID, decoded);
+    return false;
+  }
+
+  if (ueid) {
+    *ueid = decoded;
+  } else {
+    ASN_STRUCT_FREE(asn_DEF_UEID, decoded);
+  }
+
+  return true;
+}
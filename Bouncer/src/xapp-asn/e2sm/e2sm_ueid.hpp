@@ -0,0 +1,76 @@
+/*
+# ==================================================================================
+# Copyright (c) 2020 HCL Technologies Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==================================================================================
+*/
+
+
+
+/* UEID extraction from E2SM-RC indication headers */
+#ifndef SRC_XAPP_ASN_E2SM_E2SM_UEID_HPP_
+#define SRC_XAPP_ASN_E2SM_E2SM_UEID_HPP_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#include <UEID.h>
+
+#define E2SM_RC_UE_KEY_SIZE 16
+#define E2SM_RC_UE_KEY_HASHED 0x80  // set in the first key byte when the UEID is too long to be copied
+
+/*
+  Fixed-size identity of a UE. The first byte is the UEID choice, followed by the APER
+  encoding of the UEID when it fits, or by a hash, the length and the first octets of it
+  otherwise. Equal UEIDs get equal keys whatever the indication header format.
+*/
+struct e2sm_rc_ue_key {
+  uint8_t bytes[E2SM_RC_UE_KEY_SIZE];
+
+  bool operator==(const e2sm_rc_ue_key &other) const {
+    return memcmp(bytes, other.bytes, E2SM_RC_UE_KEY_SIZE) == 0;
+  };
+};
+
+// Location of the APER encoded UEID inside the indication header bytes
+struct e2sm_rc_ueid_ref {
+  e2sm_rc_ueid_ref(): buf(NULL), bit_offset(0), bit_length(0) { memset(&key, 0, sizeof(key)); };
+
+  const uint8_t *buf;   // indication header, not owned
+  size_t bit_offset;    // first bit of the UEID in buf
+  size_t bit_length;
+  e2sm_rc_ue_key key;
+};
+
+/*
+  Finds the UEID in indication header Formats 1 to 3 by walking the few bits in front of it,
+  and decodes only the UEID itself with asn1c, starting at its bit offset. This gives both
+  the bit range of the encoded UEID, which can be copied verbatim into other PDUs, and
+  its decoded form when requested.
+*/
+class e2sm_rc_ueid_decoder {
+public:
+  bool decode(const uint8_t *header, size_t size, e2sm_rc_ueid_ref &ref, UEID_t **ueid = NULL);
+
+  std::string get_error(void) const { return error_string; };
+
+private:
+  bool find_ueid(const uint8_t *header, size_t size, size_t &bit_offset, size_t &bit_limit);
+  bool make_key(e2sm_rc_ueid_ref &ref, const UEID_t *ueid);
+
+  std::string error_string;
+};
+
+#endif /* SRC_XAPP_ASN_E2SM_E2SM_UEID_HPP_ */
@@ -18,6 +18,25 @@
 
 #include "msgs_proc.hpp"
 
+// Makes an arena current for the asn1c allocations of the calling thread until the end of the scope
+class arena_scope {
+public:
+	explicit arena_scope(asn_arena_t *arena) { _previous = asn_arena_use(arena); };
+	~arena_scope() { asn_arena_use(_previous); };
+
+	arena_scope(arena_scope const &) = delete;
+	arena_scope& operator=(arena_scope const &) = delete;
+
+private:
+	asn_arena_t *_previous;
+};
+
+// Arena of the indications handled in full by operator(), emptied after each one
+struct thread_arena {
+	asn_arena_t arena = ASN_ARENA_INITIALIZER;
+	~thread_arena() { asn_arena_destroy(&arena); };
+};
+static thread_local thread_arena indication_arena;
 
 bool XappMsgHandler::encode_subscription_delete_request(unsigned char* buffer, ssize_t *buf_len){
 
@@ -135,7 +154,7 @@ bool XappMsgHandler::decode_subscription_response(unsigned char* data_buf, size_
 }*/
 
 //For processing received messages.XappMsgHandler should mention if resend is required or not.
-void XappMsgHandler::operator()(rmr_mbuf_t *message, bool *resend)
+void XappMsgHandler::operator()(rmr_mbuf_t *message, bool *resend, latency_stamps *stamps)
 {
 
 	if (message->len > MAX_RMR_RECV_SIZE)
@@ -145,7 +164,6 @@ void XappMsgHandler::operator()(rmr_mbuf_t *message, bool *resend)
 	}
 	//a1_policy_helper helper;
 	// bool res=false;
-	E2AP_PDU_t* e2pdu = (E2AP_PDU_t*)calloc(1, sizeof(E2AP_PDU));
 	// int num = 0;
 
 	switch (message->mtype)
@@ -229,105 +247,17 @@ void XappMsgHandler::operator()(rmr_mbuf_t *message, bool *resend)
 
 		case (RIC_INDICATION):
 		{
-			mdclog_write(MDCLOG_DEBUG, "Decoding indication for msg = %d", message->mtype);
-
-			ASN_STRUCT_RESET(asn_DEF_E2AP_PDU, e2pdu);
-			asn_transfer_syntax syntax;
-			syntax = ATS_ALIGNED_BASIC_PER;
-
-			mdclog_write(MDCLOG_DEBUG, "Data_size = %d", message->len);
-
-			auto rval = asn_decode(nullptr, syntax, &asn_DEF_E2AP_PDU, (void **)&e2pdu, message->payload, message->len);
-
-			if (rval.code == RC_OK)
-			{
-				mdclog_write(MDCLOG_DEBUG, "rval.code = %d ", rval.code);
+			indication_context ctx;
+			ctx.arena = &indication_arena.arena;
+			*resend = decode_indication(message, ctx);
+			if (*resend && stamps != NULL) {
+				stamps->decoded = latency_clock();
 			}
-			else
-			{
-				mdclog_write(MDCLOG_ERR, " rval.code = %d ", rval.code);
-				break;
-			}
-
-			if (mdclog_level_get() > MDCLOG_INFO)
-				asn_fprint(stderr, &asn_DEF_E2AP_PDU, e2pdu);
-
-			ric_indication indication;
-			ric_indication_helper ind_helper;
-			string error_msg;
-			indication.get_fields(e2pdu->choice.initiatingMessage, ind_helper);
-
-			uint8_t ctrl_header_buf[8192] = {0, };
-			ssize_t ctrl_header_buf_size = 8192;
-
-			UEID_t *ueid = ind_helper.get_ui_id();
-
-			e2sm_control e2sm_control;
-			bool ret_head = e2sm_control.encode_rc_control_header(ctrl_header_buf, &ctrl_header_buf_size, ueid);
-			ASN_STRUCT_FREE(asn_DEF_UEID, ueid);	// we have to release here to avoid memory leaks if encoding returns false
-			if (!ret_head) {
-				mdclog_write(MDCLOG_ERR, "%s", e2sm_control.get_error().c_str());
-				*resend = false;
-				break;
-			}
-
-			uint8_t ctrl_msg_buf[8192] = {0, };
-			ssize_t ctrl_msg_buf_size = 8192;
-
-			bool ret_msg = e2sm_control.encode_rc_control_message(ctrl_msg_buf, &ctrl_msg_buf_size);
-			if (!ret_msg) {
-				mdclog_write(MDCLOG_ERR, "%s", e2sm_control.get_error().c_str());
-				*resend = false;
-				break;
-			}
-
-			// E2AP Control Helper
-			ric_control_helper helper;
-			helper.requestor_id = ind_helper.request_id.ricRequestorID;
-			helper.instance_id = ind_helper.request_id.ricInstanceID;
-			helper.func_id = ind_helper.func_id;
-			// Control Call Process ID
-			helper.call_process_id = ind_helper.call_process_id.buf;
-			helper.call_process_id_size = ind_helper.call_process_id.size;
-			// Control ACK
-			helper.control_ack = RICcontrolAckRequest_noAck; // for now we do not require ACK messages for control requests
-			// Control Header
-			helper.control_header = ctrl_header_buf;
-			helper.control_header_size = ctrl_header_buf_size;
-			// Control Message
-			helper.control_msg = ctrl_msg_buf;
-			helper.control_msg_size = ctrl_msg_buf_size;
-
-			// E2AP buffer
-			uint8_t e2ap_buf[8192] = {0, };
-			ssize_t e2ap_buf_size = 8192;
-
-			ric_control_request control_req;
-			bool encoded = control_req.encode_e2ap_control_request(e2ap_buf, &e2ap_buf_size, helper);
-			if (encoded) {
-				message->mtype = RIC_CONTROL_REQ; // if we're here we are running and all is ok
-				message->sub_id = -1;
-
-				int rmr_len = rmr_payload_size(message);
-				if (rmr_len < 0) {
-					mdclog_write(MDCLOG_ERR, "unable to get the rmr payload size for control request. Reason = %s", strerror(errno));
-					*resend = false;
-					break;
-				}
-
-				if (e2ap_buf_size <= (ssize_t)rmr_len) {	// avoid compiler comparison complains
-					memcpy(message->payload, e2ap_buf, e2ap_buf_size);
-					message->len = e2ap_buf_size;
-					*resend = true;
-
-				} else {
-					mdclog_write(MDCLOG_ERR, "E2AP Control Request encoded size %lu exceeds rmr payload size %d", e2ap_buf_size, rmr_len);
-					*resend = false;
-				}
-			} else {
-				mdclog_write(MDCLOG_ERR, "E2AP Control Request encoding error. Reason = %s", control_req.get_error().c_str());
-				*resend = false;
+			*resend = *resend && encode_control_request(message, ctx);
+			if (*resend && stamps != NULL) {
+				stamps->encoded = latency_clock();
 			}
+			release_indication(ctx);
 
 			if (mdclog_level_get() > MDCLOG_INFO)
 				fprintf(stderr, "end of RIC_INDICATION case\n\n");
@@ -354,8 +284,176 @@ void XappMsgHandler::operator()(rmr_mbuf_t *message, bool *resend)
 			mdclog_write(MDCLOG_ERR, "Error :: Unknown message type %d received from RMR", message->mtype);
 			*resend = false;
 	}
+}
 
-	ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, e2pdu);
+// Locates the UEID in the E2SM-RC indication header, its encoded bits are reused by the control header
+static void decode_indication_ueid(indication_context &ctx)
+{
+	e2sm_rc_ueid_decoder decoder;
+
+	if (!decoder.decode(ctx.ind_helper.indication_header.buf, ctx.ind_helper.indication_header.size, ctx.ue, &ctx.ueid)) {
+		mdclog_write(MDCLOG_ERR, "Error :: %s, %d :: %s", __FILE__, __LINE__, decoder.get_error().c_str());
+		metrics_count(METRIC_DECODE_ERRORS);
+	}
+}
+
+/*
+	Decode stage of a RIC_INDICATION: decodes the E2AP PDU and collects the fields required
+	to build the control request, including the decision on the UE to be controlled.
+	The context must be released with release_indication() in any case.
+*/
+bool XappMsgHandler::decode_indication(rmr_mbuf_t *message, indication_context &ctx)
+{
+	mdclog_write(MDCLOG_DEBUG, "Decoding indication for msg = %d", message->mtype);
+
+	arena_scope scope(ctx.arena);
+
+	asn_transfer_syntax syntax;
+	syntax = ATS_ALIGNED_BASIC_PER;
+
+	mdclog_write(MDCLOG_DEBUG, "Data_size = %d", message->len);
+
+	// the full decode is only required for unusual encodings, or to print the PDU when debugging
+	IndicationView view;
+	if (mdclog_level_get() <= MDCLOG_INFO && view.parse(message->payload, message->len) && view.get_fields(ctx.ind_helper)
+			&& ctx.ind_helper.call_process_id.size <= INDICATION_CALL_PROCESS_ID_SIZE) {
+		if (ctx.ind_helper.call_process_id.size > 0) {
+			memcpy(ctx.call_process_id, ctx.ind_helper.call_process_id.buf, ctx.ind_helper.call_process_id.size);
+			ctx.ind_helper.call_process_id.buf = ctx.call_process_id;
+		}
+		decode_indication_ueid(ctx);
+
+		return true;
+	}
+	ctx.ind_helper = ric_indication_helper();	// drops whatever the view has filled in
+
+	auto rval = asn_decode(nullptr, syntax, &asn_DEF_E2AP_PDU, (void **)&ctx.e2pdu, message->payload, message->len);
+
+	if (rval.code == RC_OK)
+	{
+		mdclog_write(MDCLOG_DEBUG, "rval.code = %d ", rval.code);
+	}
+	else
+	{
+		mdclog_write(MDCLOG_ERR, " rval.code = %d ", rval.code);
+		metrics_count(METRIC_DECODE_ERRORS);
+		return false;
+	}
+
+	if (mdclog_level_get() > MDCLOG_INFO)
+		asn_fprint(stderr, &asn_DEF_E2AP_PDU, ctx.e2pdu);
+
+	_codecs.indication.get_fields(ctx.e2pdu->choice.initiatingMessage, ctx.ind_helper);
+
+	decode_indication_ueid(ctx);
+
+	return true;
+}
+
+/*
+	Encode stage of a RIC_INDICATION: encodes the RIC control request for the decoded indication
+	and replaces the rmr message payload with it, so the message can be returned to sender.
+*/
+/*
+	The E2SM control header and message are only needed until they have been copied into the E2AP PDU,
+	so every indication handled by a thread encodes them into the same scratch space, one after the other.
+*/
+static thread_local uint8_t e2sm_scratch[E2SM_SCRATCH_SIZE];
+
+bool XappMsgHandler::encode_control_request(rmr_mbuf_t *message, indication_context &ctx)
+{
+	arena_scope scope(ctx.arena);
+
+	uint8_t *ctrl_header_buf = e2sm_scratch;
+	ssize_t ctrl_header_buf_size = E2SM_SCRATCH_SIZE;
+
+	bool ret_head = _codecs.e2sm.encode_rc_control_header(ctrl_header_buf, &ctrl_header_buf_size, ctx.ue, ctx.ueid);
+	if (!ret_head) {
+		mdclog_write(MDCLOG_ERR, "%s", _codecs.e2sm.get_error().c_str());
+		metrics_count(METRIC_ENCODE_ERRORS);
+		return false;
+	}
+
+	uint8_t *ctrl_msg_buf = e2sm_scratch + ctrl_header_buf_size;
+	ssize_t ctrl_msg_buf_size = E2SM_SCRATCH_SIZE - ctrl_header_buf_size;
+
+	// for now every UE is accepted and its control message targets the default cell
+	bool ret_msg = _control_msg_cache.get_control_message(ctrl_msg_buf, &ctrl_msg_buf_size, E2SM_RC_DEFAULT_PLMN,
+			E2SM_RC_DEFAULT_NR_CELL_ID, E2SM_RC_ControlHeader_Format1__ric_ControlDecision_accept);
+	if (!ret_msg) {
+		mdclog_write(MDCLOG_ERR, "%s", _control_msg_cache.get_error().c_str());
+		metrics_count(METRIC_ENCODE_ERRORS);
+		return false;
+	}
+
+	ric_indication_helper &ind_helper = ctx.ind_helper;
+
+	// E2AP Control Helper
+	ric_control_helper helper;
+	helper.requestor_id = ind_helper.request_id.ricRequestorID;
+	helper.instance_id = ind_helper.request_id.ricInstanceID;
+	helper.func_id = ind_helper.func_id;
+	// Control Call Process ID
+	helper.call_process_id = ind_helper.call_process_id.buf;
+	helper.call_process_id_size = ind_helper.call_process_id.size;
+	// Control ACK
+	helper.control_ack = RICcontrolAckRequest_noAck; // for now we do not require ACK messages for control requests
+	// Control Header
+	helper.control_header = ctrl_header_buf;
+	helper.control_header_size = ctrl_header_buf_size;
+	// Control Message
+	helper.control_msg = ctrl_msg_buf;
+	helper.control_msg_size = ctrl_msg_buf_size;
+
+	int rmr_len = rmr_payload_size(message);
+	if (rmr_len < 0) {
+		mdclog_write(MDCLOG_ERR, "unable to get the rmr payload size for control request. Reason = %s", strerror(errno));
+		metrics_count(METRIC_ENCODE_ERRORS);
+		return false;
+	}
+
+	// The indication has been fully decoded into ctx, so the control request is encoded straight over its payload
+	ssize_t e2ap_buf_size = rmr_len;
+	ric_control_request &control_req = _codecs.control_req;
+	control_req.set_fast_encoding(_fast_control_encoder);
+	bool encoded = control_req.encode_e2ap_control_request(message->payload, &e2ap_buf_size, helper);
+
+	if (!encoded && e2ap_buf_size > (ssize_t)rmr_len) {	// e2ap_buf_size is now the required payload size
+		mdclog_write(MDCLOG_DEBUG, "Growing rmr payload from %d to %lu bytes for control request", rmr_len, e2ap_buf_size);
+		if (rmr_realloc_payload(message, e2ap_buf_size, 0, 0) == NULL) {	// not cloned, so message is updated in place
+			mdclog_write(MDCLOG_ERR, "unable to grow the rmr payload for control request. Reason = %s", strerror(errno));
+			metrics_count(METRIC_ENCODE_ERRORS);
+			return false;
+		}
+		encoded = control_req.encode_e2ap_control_request(message->payload, &e2ap_buf_size, helper);
+	}
+
+	if (!encoded) {
+		mdclog_write(MDCLOG_ERR, "E2AP Control Request encoding error. Reason = %s", control_req.get_error().c_str());
+		metrics_count(METRIC_ENCODE_ERRORS);
+		return false;
+	}
+
+	message->mtype = RIC_CONTROL_REQ; // if we're here we are running and all is ok
+	message->sub_id = -1;
+	message->len = e2ap_buf_size;
+
+	return true;
+}
+
+void XappMsgHandler::release_indication(indication_context &ctx)
+{
+	arena_scope scope(ctx.arena);
+
+	ASN_STRUCT_FREE(asn_DEF_UEID, ctx.ueid);	// we have to release here to avoid memory leaks if encoding returns false
+	ctx.ueid = NULL;
+	ctx.ue = e2sm_rc_ueid_ref();
+	ASN_STRUCT_FREE(asn_DEF_E2AP_PDU, ctx.e2pdu);
+	ctx.e2pdu = NULL;
+	ctx.ind_helper = ric_indication_helper();
+	_codecs.reset();
+
+	asn_arena_reset(ctx.arena);	// everything the indication allocated from the arena is gone now
 }
 
 
@@ -33,6 +33,7 @@
 #include "E2SM-RC-IndicationMessage-Format5-Item.h"
 #include "e2ap_control_response.hpp"
 #include "e2ap_indication.hpp"
+#include "e2ap_indication_view.hpp"
 #include "subscription_delete_request.hpp"
 #include "subscription_delete_response.hpp"
 #include "subscription_helper.hpp"
@@ -41,20 +42,69 @@
 #include "e2sm_subscription.hpp"
 #include "subs_mgmt.hpp"
 #include "e2sm_control.hpp"
+#include "e2sm_control_cache.hpp"
+#include "e2sm_ueid.hpp"
+#include "asn_arena.h"
+#include "xapp_latency.hpp"
+#include "xapp_metrics.hpp"
 
 #define MAX_RMR_RECV_SIZE 2<<15
+#define E2SM_SCRATCH_SIZE 8192	// per thread space for encoding the E2SM control header and message
+#define INDICATION_CALL_PROCESS_ID_SIZE 64	// longer call process ids take the full decode path
 
+// State carried from the decode to the encode stage of a RIC_INDICATION
+struct indication_context {
+	indication_context(): e2pdu(NULL), ueid(NULL), arena(NULL) {};
+
+	E2AP_PDU_t *e2pdu;	// NULL unless the indication needed the full asn1c decode
+	ric_indication_helper ind_helper;	// fields point into e2pdu, or into the rmr payload otherwise
+	UEID_t *ueid;
+	e2sm_rc_ueid_ref ue;	// encoded UEID and its key, the bits are only valid until the payload is overwritten
+	uint8_t call_process_id[INDICATION_CALL_PROCESS_ID_SIZE];	// the payload is overwritten by the control request
+	asn_arena_t *arena;	// asn1c memory of this indication, the heap is used when NULL
+};
+
+/*
+	Codec objects reused by all the indications of a worker. A copy starts out with objects
+	of its own, so copies of the handler never share them, and reset() releases whatever
+	an indication left in them while its arena is still current.
+*/
+struct indication_codecs {
+	indication_codecs() {};
+	indication_codecs(indication_codecs const &) {};
+	indication_codecs& operator=(indication_codecs const &) { return *this; };
+
+	void reset(void) { e2sm.reset(); control_req.reset(); };
+
+	ric_indication indication;
+	e2sm_control e2sm;
+	ric_control_request control_req;
+};
+
+// Each receiver thread works on its own copy of the handler, hence any state kept here is per worker
 class XappMsgHandler{
 
 private:
 	std::string xapp_id;
 	SubscriptionHandler *_ref_sub_handler;
+	e2sm_control_cache _control_msg_cache;	// copied along with the handler, so it is never shared between workers
+	bool _fast_control_encoder;
+	indication_codecs _codecs;
 public:
 	//constructor for xapp_id.
-	 XappMsgHandler(std::string xid){xapp_id=xid; _ref_sub_handler=NULL;};
-	 XappMsgHandler(std::string xid, SubscriptionHandler &subhandler){xapp_id=xid; _ref_sub_handler=&subhandler;};
+	 XappMsgHandler(std::string xid){xapp_id=xid; _ref_sub_handler=NULL; _fast_control_encoder=false;};
+	 XappMsgHandler(std::string xid, SubscriptionHandler &subhandler){xapp_id=xid; _ref_sub_handler=&subhandler; _fast_control_encoder=false;};
+
+	 // must be set before the handler is copied to the receiver threads
+	 void set_fast_control_encoder(bool enable) { _fast_control_encoder = enable; };
+
+	 // stamps, when given, get the decode and encode times of an answered indication
+	 void operator() (rmr_mbuf_t *, bool*, latency_stamps * = NULL);
 
-	 void operator() (rmr_mbuf_t *, bool*);
+	 // RIC_INDICATION stages, operator() runs them in sequence
+	 bool decode_indication(rmr_mbuf_t *, indication_context &);
+	 bool encode_control_request(rmr_mbuf_t *, indication_context &);
+	 void release_indication(indication_context &);
 
 	 void register_handler();
 	 bool encode_subscription_delete_request(unsigned char*, ssize_t* );
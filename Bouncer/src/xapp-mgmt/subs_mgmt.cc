@@ -22,97 +22,120 @@
  */
 #include "subs_mgmt.hpp"
 #include <thread>
+#include <iostream>
 #include <errno.h>
 
 SubscriptionHandler::SubscriptionHandler(unsigned int timeout_seconds):_time_out(std::chrono::seconds(timeout_seconds)){
-	  _data_lock = std::make_unique<std::mutex>();
-	  _cv = std::make_unique<std::condition_variable>();
 };
 
-void SubscriptionHandler::clear(void){
-  {
-    std::lock_guard<std::mutex> lock(*(_data_lock).get());
-    status_table.clear();
-  }
+void SubscriptionHandler::set_timeout(unsigned int timeout_seconds){
+	_time_out = std::chrono::seconds(timeout_seconds);
+}
+
+SubscriptionHandler::Shard &SubscriptionHandler::shard_of(const transaction_identifier &id){
+	return _shards[std::hash<transaction_identifier>()(id) % SUBSCR_SHARDS];
+}
 
+void SubscriptionHandler::clear(void){
+	for (auto &shard : _shards) {
+		std::lock_guard<std::mutex> lock(shard.lock);
+		shard.table.clear();
+	}
 };
 
+size_t SubscriptionHandler::size(void){
+	size_t entries = 0;
+	for (auto &shard : _shards) {
+		std::lock_guard<std::mutex> lock(shard.lock);
+		entries += shard.table.size();
+	}
+	return entries;
+}
 
-bool SubscriptionHandler::add_request_entry(transaction_identifier id, transaction_status status){
+void SubscriptionHandler::print_subscription_status(void){
+	for (auto &shard : _shards) {
+		std::lock_guard<std::mutex> lock(shard.lock);
+		for (auto &it : shard.table) {
+			std::cout << it.first << "::" << it.second.status << std::endl;
+		}
+	}
+}
 
-  // add entry in hash table if it does not exist
-  auto search = status_table.find(id);
-  if(search != status_table.end()){
-    return false;
-  }
 
-  status_table[id] = status;
-  return true;
+bool SubscriptionHandler::add_request_entry(transaction_identifier id, transaction_status status){
+	Shard &shard = shard_of(id);
+	std::lock_guard<std::mutex> lock(shard.lock);
 
+	// add entry in hash table if it does not exist
+	request_entry entry;
+	entry.status = status;
+	return shard.table.emplace(id, std::move(entry)).second;
 };
 
 
+bool SubscriptionHandler::add_transmitter_entry(transaction_identifier id, subscription_transmitter transmitter){
+	Shard &shard = shard_of(id);
+	std::lock_guard<std::mutex> lock(shard.lock);
 
-bool SubscriptionHandler::delete_request_entry(transaction_identifier id){
+	auto search = shard.table.find(id);
+	if (search == shard.table.end()) {
+		return false;	// a response or a delete came first
+	}
 
-  auto search = status_table.find(id);
+	search->second.transmitter = std::move(transmitter);
+	mdclog_write(MDCLOG_INFO,"Entry added for Transaction ID: %s", id.c_str());
+	return true;
+};
 
-  if (!trans_table.empty()) {
-	  auto search2 = trans_table.find(id);
-	  if(search2 !=trans_table.end()){
-		  trans_table.erase(search2);
-	  }
-  }
 
-  if (search != status_table.end()){
-    status_table.erase(search);
-    mdclog_write(MDCLOG_INFO,"Entry for Transaction ID deleted: %s",id.c_str());
-    return true;
-  }
-  mdclog_write(MDCLOG_INFO,"Entry not found in SubscriptionHandler for Transaction ID: %s",id.c_str());
+bool SubscriptionHandler::delete_request_entry(transaction_identifier id){
+	Shard &shard = shard_of(id);
+	std::lock_guard<std::mutex> lock(shard.lock);
 
-  return false;
+	if (shard.table.erase(id) > 0) {
+		mdclog_write(MDCLOG_INFO,"Entry for Transaction ID deleted: %s",id.c_str());
+		return true;
+	}
+	mdclog_write(MDCLOG_INFO,"Entry not found in SubscriptionHandler for Transaction ID: %s",id.c_str());
+
+	return false;
 };
 
 
 bool SubscriptionHandler::set_request_status(transaction_identifier id, transaction_status status){
+	Shard &shard = shard_of(id);
+	std::lock_guard<std::mutex> lock(shard.lock);
 
-  // change status of a request only if it exists.
-	for(auto &it:status_table){
-			if(strcmp(it.first.c_str(), id.c_str())==0) {
-				it.second = status;
-				return true;
-			}
-		}
-  return false;
+	// change status of a request only if it exists.
+	auto search = shard.table.find(id);
+	if (search == shard.table.end()) {
+		return false;
+	}
 
+	search->second.status = status;
+	return true;
 };
 
 
 int SubscriptionHandler::get_request_status(transaction_identifier id){
+	Shard &shard = shard_of(id);
+	std::lock_guard<std::mutex> lock(shard.lock);
 
-	for(auto it:status_table){
-		if(strcmp(it.first.c_str(), id.c_str())==0) {
-			return it.second;
-		}
+	auto search = shard.table.find(id);
+	if (search == shard.table.end()) {
+		return -1;
 	}
 
-
-  return -1;
+	return search->second.status;
 }
 
 
-
 bool SubscriptionHandler::is_request_entry(transaction_identifier id){
-	for(auto it:status_table){
-			if(strcmp(it.first.c_str(), id.c_str())==0) {
-				return true;
-			}
-		}
-    return false;
-}
-
+	Shard &shard = shard_of(id);
+	std::lock_guard<std::mutex> lock(shard.lock);
 
+	return shard.table.find(id) != shard.table.end();
+}
 
 
 // Handles subscription responses
@@ -121,7 +144,7 @@ void SubscriptionHandler::manage_subscription_response(int message_type, transac
 	// Make This Thread sleep for 1 Second
   	std::this_thread::sleep_for(std::chrono::milliseconds(1000));
   	{
-	  	std::unique_lock<std::mutex> _local_lock(*(_data_lock.get()));
+	  	// every call below takes the lock of the shard of id on its own
 	  	mdclog_write(MDCLOG_INFO,"Subscription Handler: Status for meid %s WAS: %d",id.c_str(),this->get_request_status(id));
 
 	  	//from the message type we can know if its a success/failure etc.
@@ -142,7 +165,6 @@ void SubscriptionHandler::manage_subscription_response(int message_type, transac
 
 	  	//this->print_subscription_status();
    	}
-  	//_cv.get()->notify_all();
 
 }
 
@@ -52,39 +52,8 @@
 #define SUBSCR_ERR_NOT_FOUND -6
 using namespace std;
 
-class TransmitterBase
-{
-public:
-    virtual ~TransmitterBase() {}
-
-    template<class T>
-    const T& getParam() const; //to be implemented after Parameter
-
-    template<class T, class U>
-    void setParam(const U& rhs); //to be implemented after Parameter
-};
-
-template <typename T>
-class Transmitter : public TransmitterBase
-{
-public:
-	Transmitter(const T& tx) :obj(tx) {}
-    const T& getParam() const {return obj;}
-    void setParam(const T& tx) {obj=tx;}
-private:
-    T obj;
-};
-
-//Here's the trick: dynamic_cast rather than virtual
-template<class T> const T& TransmitterBase::getParam() const
-{
-	return dynamic_cast<const Transmitter<T>&>(*this).getParam();
-}
-template<class T, class U> void TransmitterBase::setParam(const U& rhs)
-{
-	dynamic_cast<Transmitter<T>&>(*this).setParam(rhs);
-	return;
-}
+// Sends a subscription (delete) request, returns false when it could not be transmitted
+using subscription_transmitter = std::function<bool(void)>;
 
 typedef enum {
     request_pending = 1,
@@ -97,12 +66,23 @@ typedef enum {
 using transaction_identifier = std::string;
 using transaction_status = Subscription_Status_Types;
 
+#define SUBSCR_SHARDS 64	// transaction ids are spread over this many independently locked tables
+
+/*
+	Keeps the state of the outstanding subscription transactions, keyed by transaction id.
+	The ids are hashed into shards, each one a hash table with a lock of its own, so lookups
+	and updates take constant time and only contend with transactions of the same shard.
+	Transmitters are never called with a shard lock held.
+*/
 class SubscriptionHandler {
-			    
+
 public:
 
   SubscriptionHandler(unsigned int timeout_seconds = 30);
-  
+
+  SubscriptionHandler(SubscriptionHandler const &) = delete;
+  SubscriptionHandler& operator=(SubscriptionHandler const &) = delete;
+
   template <typename AppTransmitter>
   int manage_subscription_request(transaction_identifier, AppTransmitter &&);
 
@@ -114,140 +94,87 @@ public:
   int  get_request_status(transaction_identifier);
   bool set_request_status(transaction_identifier, transaction_status);
   bool is_request_entry(transaction_identifier);
+  size_t size(void);
   void set_timeout(unsigned int);
   void clear(void);
   void set_ignore_subs_resp(bool b){_ignore_subs_resp = b;};
 
-  void print_subscription_status(){ for(auto it:status_table){std::cout << it.first << "::" << it.second << std::endl;}};
+  void print_subscription_status(void);
 
 private:
-  
-  bool add_request_entry(transaction_identifier, transaction_status);
-  bool delete_request_entry(transaction_identifier);
-
-  template <typename AppTransmitter>
-  bool add_transmitter_entry(transaction_identifier, AppTransmitter&&);
-
-  std::unordered_map<transaction_identifier, TransmitterBase> trans_table;
-  std::unordered_map<transaction_identifier, transaction_status> status_table;
 
-  std::unique_ptr<std::mutex> _data_lock;
-  std::unique_ptr<std::condition_variable> _cv;
+  struct request_entry {
+    transaction_status status;
+    subscription_transmitter transmitter;	// kept to retransmit the request, empty until it has been sent
+  };
 
-  std::chrono::seconds _time_out;
-  
-  bool _ignore_subs_resp = false;
-};
-
-template <typename AppTransmitter>
-bool SubscriptionHandler::add_transmitter_entry(transaction_identifier id, AppTransmitter &&trans){
+  struct Shard {
+    std::mutex lock;
+    std::unordered_map<transaction_identifier, request_entry> table;
+  };
 
-	mdclog_write(MDCLOG_INFO,"Entry added for Transaction ID: %s", id.c_str());
+  Shard &shard_of(const transaction_identifier &);
 
+  bool add_request_entry(transaction_identifier, transaction_status);
+  bool delete_request_entry(transaction_identifier);
+  bool add_transmitter_entry(transaction_identifier, subscription_transmitter);
 
-  // add entry in hash table if it does not exist
-  auto search = trans_table.find(id);
-  if(search != trans_table.end()){
-    return false;
-  }
+  Shard _shards[SUBSCR_SHARDS];
 
-  Transmitter<AppTransmitter> tptr(trans);
-  trans_table[id] = tptr;
-  return true;
+  std::chrono::seconds _time_out;
 
+  bool _ignore_subs_resp = false;
 };
 
 //this will work for both sending subscription request and subscription delete request.
 //The handler is oblivious of the message content and follows the transaction id.
 template<typename AppTransmitter>
 int SubscriptionHandler::manage_subscription_request(transaction_identifier rmr_trans_id, AppTransmitter && tx){
-	int res;
-  // put entry in request table
-  {
-    std::lock_guard<std::mutex> lock(*(_data_lock.get()));
-    res = add_request_entry(rmr_trans_id, request_pending);
-    if(! res){
-		
-      mdclog_write(MDCLOG_ERR, "%s : Error adding new subscription request %s to queue because request with identical key already present",  __FILE__, __LINE__);
-	  
-      return SUBSCR_ERR_DUPLICATE;
-    }
-  }
-
-
-  // acquire lock ...
-  std::unique_lock<std::mutex> _local_lock(*(_data_lock.get()));
-  // Send the message
-  bool flg = tx();
-  if (!flg){
-    // clear state
-    delete_request_entry(rmr_trans_id);
-    mdclog_write(MDCLOG_ERR, "%s, %d :: Error transmitting subscription request %s", __FILE__, __LINE__, rmr_trans_id.c_str());
-    return SUBSCR_ERR_TX;
-  } else {
-	  mdclog_write(MDCLOG_INFO, "%s, %d :: Transmitted subscription request for trans_id  %s", __FILE__, __LINE__, rmr_trans_id.c_str());
-	  add_transmitter_entry(rmr_trans_id, tx);
-
-  }
-
-  // record time stamp ..
-  auto start = std::chrono::system_clock::now();
-  std::chrono::milliseconds t_out(_time_out);
-
-  //the wait functionality has been removed.
-
-
-  _local_lock.unlock();
-  // std::cout <<"Returning  res = " << res << " for request = " << rmr_trans_id  << std::endl;
-   return res;
+	subscription_transmitter transmitter(std::forward<AppTransmitter>(tx));
+
+	// put entry in request table
+	if (!add_request_entry(rmr_trans_id, request_pending)) {
+		mdclog_write(MDCLOG_ERR, "%s, %d :: Error adding new subscription request %s to queue because request with identical key already present", __FILE__, __LINE__, rmr_trans_id.c_str());
+		return SUBSCR_ERR_DUPLICATE;
+	}
+
+	// Send the message
+	if (!transmitter()) {
+		// clear state
+		delete_request_entry(rmr_trans_id);
+		mdclog_write(MDCLOG_ERR, "%s, %d :: Error transmitting subscription request %s", __FILE__, __LINE__, rmr_trans_id.c_str());
+		return SUBSCR_ERR_TX;
+	}
+
+	mdclog_write(MDCLOG_INFO, "%s, %d :: Transmitted subscription request for trans_id  %s", __FILE__, __LINE__, rmr_trans_id.c_str());
+	add_transmitter_entry(rmr_trans_id, std::move(transmitter));
+
+	//the wait functionality has been removed.
+	return SUBSCR_SUCCESS;
 };
 
 template<typename AppTransmitter>
-int SubscriptionHandler:: manage_subscription_delete_request(transaction_identifier rmr_trans_id, AppTransmitter && tx)
+int SubscriptionHandler::manage_subscription_delete_request(transaction_identifier rmr_trans_id, AppTransmitter && tx)
 {
-	int res;
-  	// delete  entry in request table
-  	{
-    		std::lock_guard<std::mutex> lock(*(_data_lock.get()));
-    		res = delete_request_entry(rmr_trans_id);
-     		mdclog_write(MDCLOG_INFO,"res=%d",res);
-    		if(! res)
-		{
-      			mdclog_write(MDCLOG_ERR, "%s : Error deleting new subscription request %s from queue because request with key doesn't present",  __FILE__, __LINE__);
-
-      			return SUBSCR_ERR_NOT_FOUND;
-    		}
-
-  	}
-
-
-  	// acquire lock ...
-  	std::unique_lock<std::mutex> _local_lock(*(_data_lock.get()));
-  	// Send the message
-  	bool flg = tx();
-
-  	if (!flg)
-	{
-    		// add state
-    		res = add_request_entry(rmr_trans_id, request_pending);
-    		mdclog_write(MDCLOG_ERR, "%s, %d :: Error transmitting subscription delete request %s", __FILE__, __LINE__, rmr_trans_id.c_str());
-    		return SUBSCR_ERR_TX;
-  	} 
-	else 
-	{
-          	mdclog_write(MDCLOG_INFO, "%s, %d :: Transmitted subscription delete request for trans_id  %s", __FILE__, __LINE__, rmr_trans_id.c_str());
-
-  	}
-
- 	// record time stamp ..
-  	auto start = std::chrono::system_clock::now();
-  	std::chrono::milliseconds t_out(_time_out);
-
-  	//the wait functionality has been removed.
-
-
- 	_local_lock.unlock();
-  	// std::cout <<"Returning  res = " << res << " for request = " << rmr_trans_id  << std::endl;
-   	return res;
+	subscription_transmitter transmitter(std::forward<AppTransmitter>(tx));
+
+	// delete entry in request table
+	if (!delete_request_entry(rmr_trans_id)) {
+		mdclog_write(MDCLOG_ERR, "%s, %d :: Error deleting subscription request %s from queue because request with key is not present", __FILE__, __LINE__, rmr_trans_id.c_str());
+		return SUBSCR_ERR_NOT_FOUND;
+	}
+
+	// Send the message
+	if (!transmitter()) {
+		// add state
+		add_request_entry(rmr_trans_id, request_pending);
+		mdclog_write(MDCLOG_ERR, "%s, %d :: Error transmitting subscription delete request %s", __FILE__, __LINE__, rmr_trans_id.c_str());
+		return SUBSCR_ERR_TX;
+	}
+
+	mdclog_write(MDCLOG_INFO, "%s, %d :: Transmitted subscription delete request for trans_id  %s", __FILE__, __LINE__, rmr_trans_id.c_str());
+
+	//the wait functionality has been removed.
+	return SUBSCR_SUCCESS;
 };
 #endif
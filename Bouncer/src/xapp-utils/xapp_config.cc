@@ -53,6 +53,8 @@ void XappSettings::usage(char *command){
 	std::cout << "  -i  --xappid    xApp instance id" << std::endl;
 	std::cout << "  -p  --port      Port to listen on (e.g. 4560)" << std::endl;
 	std::cout << "  -t  --threads   Number of listener threads" << std::endl;
+	std::cout << "  -m  --mode      Receiver mode when using multiple threads (shared, sharded, pipeline)" << std::endl;
+	std::cout << "  -s  --stages    Decode,encode,send threads in pipeline mode (e.g. 2,2,1)" << std::endl;
 	std::cout << "  -b  --nodebid   E2 NodeB ID to subscribe (e.g. 12, 0xC)" << std::endl;
 	std::cout << "  -c  --mcc       Mobile Country Code of NodeB to subscribe" << std::endl;
 	std::cout << "  -n  --mnc       Mobile Network Code of NodeB to subscribe" << std::endl;
@@ -69,6 +71,8 @@ void XappSettings::loadCmdlineSettings(int argc, char **argv)
 			{"xappid", required_argument, 0, 'i'},
 			{"port", required_argument, 0, 'p'},
 			{"threads", required_argument, 0, 't'},
+			{"mode", required_argument, 0, 'm'},
+			{"stages", required_argument, 0, 's'},
 			{"nodebid", required_argument, 0, 'b'},
 			{"mcc", required_argument, 0, 'c'},
 			{"mnc", required_argument, 0, 'n'},
@@ -78,7 +82,7 @@ void XappSettings::loadCmdlineSettings(int argc, char **argv)
 
 	while (1) {
 		int option_index = 0;
-		char c = getopt_long(argc, argv, "x:i:p:t:b:c:n:h", long_options, &option_index);
+		char c = getopt_long(argc, argv, "x:i:p:t:m:s:b:c:n:h", long_options, &option_index);
 
 		if (c == -1) {
 			break;
@@ -105,6 +109,16 @@ void XappSettings::loadCmdlineSettings(int argc, char **argv)
 				mdclog_write(MDCLOG_INFO, "Number of threads set to %s from command line\n", theSettings[THREADS].c_str());
 				break;
 
+			case 'm':
+				theSettings[RECEIVER_MODE].assign(optarg);
+				mdclog_write(MDCLOG_INFO, "Receiver mode set to %s from command line\n", theSettings[RECEIVER_MODE].c_str());
+				break;
+
+			case 's':
+				theSettings[PIPELINE_THREADS].assign(optarg);
+				mdclog_write(MDCLOG_INFO, "Pipeline threads set to %s from command line\n", theSettings[PIPELINE_THREADS].c_str());
+				break;
+
 			case 'b':
 			{
 				unsigned long nodebid_num = 0;
@@ -181,6 +195,45 @@ void XappSettings::loadDefaultSettings(){
 	if(theSettings[THREADS].empty()){
 		theSettings[THREADS] = DEFAULT_THREADS;
 	}
+	if(theSettings[BUSY_POLL].empty()){
+		theSettings[BUSY_POLL] = DEFAULT_BUSY_POLL;
+	}
+	if(theSettings[CPU_AFFINITY].empty()){
+		theSettings[CPU_AFFINITY] = DEFAULT_CPU_AFFINITY;
+	}
+	if(theSettings[SCHED_PRIORITY].empty()){
+		theSettings[SCHED_PRIORITY] = DEFAULT_SCHED_PRIORITY;
+	}
+	if(theSettings[RETRY_QUEUE_SIZE].empty()){
+		theSettings[RETRY_QUEUE_SIZE] = DEFAULT_RETRY_QUEUE_SIZE;
+	}
+	if(theSettings[RETRY_DROP_POLICY].empty()){
+		theSettings[RETRY_DROP_POLICY] = DEFAULT_RETRY_DROP_POLICY;
+	}
+	if(theSettings[RECEIVER_MODE].empty()){
+		theSettings[RECEIVER_MODE] = DEFAULT_RECEIVER_MODE;
+	}
+	if(theSettings[PIPELINE_THREADS].empty()){
+		theSettings[PIPELINE_THREADS] = DEFAULT_PIPELINE_THREADS;
+	}
+	if(theSettings[CONTROL_ENCODER].empty()){
+		theSettings[CONTROL_ENCODER] = DEFAULT_CONTROL_ENCODER;
+	}
+	if(theSettings[SUBSCRIPTION_CONCURRENCY].empty()){
+		theSettings[SUBSCRIPTION_CONCURRENCY] = DEFAULT_SUBSCRIPTION_CONCURRENCY;
+	}
+	if(theSettings[SHUTDOWN_DEADLINE].empty()){
+		theSettings[SHUTDOWN_DEADLINE] = DEFAULT_SHUTDOWN_DEADLINE;
+	}
+	if(theSettings[SUBMGR_ENDPOINT].empty()){
+		theSettings[SUBMGR_ENDPOINT] = DEFAULT_SUBMGR_ENDPOINT;
+	}
+	if(theSettings[APPMGR_ENDPOINT].empty()){
+		theSettings[APPMGR_ENDPOINT] = DEFAULT_APPMGR_ENDPOINT;
+	}
+	if(theSettings[E2MGR_ENDPOINT].empty()){
+		theSettings[E2MGR_ENDPOINT] = DEFAULT_E2MGR_ENDPOINT;
+	}
 	if(theSettings[CONFIG_FILE].empty()){
 		theSettings[CONFIG_FILE] = DEFAULT_CONFIG_FILE;
 	}
@@ -215,6 +268,58 @@ void XappSettings::loadEnvVarSettings(){
 		theSettings[THREADS].assign(env_threads);
 		mdclog_write(MDCLOG_INFO,"Threads set to %s from environment variable", theSettings[THREADS].c_str());
 	}
+	if (const char *env_busy_poll = std::getenv("BUSY_POLL")){
+		theSettings[BUSY_POLL].assign(env_busy_poll);
+		mdclog_write(MDCLOG_INFO,"Busy poll set to %s from environment variable", theSettings[BUSY_POLL].c_str());
+	}
+	if (const char *env_cpus = std::getenv("CPU_AFFINITY")){
+		theSettings[CPU_AFFINITY].assign(env_cpus);
+		mdclog_write(MDCLOG_INFO,"CPU affinity set to %s from environment variable", theSettings[CPU_AFFINITY].c_str());
+	}
+	if (const char *env_priority = std::getenv("SCHED_PRIORITY")){
+		theSettings[SCHED_PRIORITY].assign(env_priority);
+		mdclog_write(MDCLOG_INFO,"SCHED_FIFO priority set to %s from environment variable", theSettings[SCHED_PRIORITY].c_str());
+	}
+	if (const char *env_retry_size = std::getenv("RETRY_QUEUE_SIZE")){
+		theSettings[RETRY_QUEUE_SIZE].assign(env_retry_size);
+		mdclog_write(MDCLOG_INFO,"Retry queue size set to %s from environment variable", theSettings[RETRY_QUEUE_SIZE].c_str());
+	}
+	if (const char *env_retry_policy = std::getenv("RETRY_DROP_POLICY")){
+		theSettings[RETRY_DROP_POLICY].assign(env_retry_policy);
+		mdclog_write(MDCLOG_INFO,"Retry drop policy set to %s from environment variable", theSettings[RETRY_DROP_POLICY].c_str());
+	}
+	if (const char *env_mode = std::getenv("RECEIVER_MODE")){
+		theSettings[RECEIVER_MODE].assign(env_mode);
+		mdclog_write(MDCLOG_INFO,"Receiver mode set to %s from environment variable", theSettings[RECEIVER_MODE].c_str());
+	}
+	if (const char *env_stages = std::getenv("PIPELINE_THREADS")){
+		theSettings[PIPELINE_THREADS].assign(env_stages);
+		mdclog_write(MDCLOG_INFO,"Pipeline threads set to %s from environment variable", theSettings[PIPELINE_THREADS].c_str());
+	}
+	if (const char *env_encoder = std::getenv("CONTROL_ENCODER")){
+		theSettings[CONTROL_ENCODER].assign(env_encoder);
+		mdclog_write(MDCLOG_INFO,"Control encoder set to %s from environment variable", theSettings[CONTROL_ENCODER].c_str());
+	}
+	if (const char *env_subs = std::getenv("SUBSCRIPTION_CONCURRENCY")){
+		theSettings[SUBSCRIPTION_CONCURRENCY].assign(env_subs);
+		mdclog_write(MDCLOG_INFO,"Subscription concurrency set to %s from environment variable", theSettings[SUBSCRIPTION_CONCURRENCY].c_str());
+	}
+	if (const char *env_deadline = std::getenv("SHUTDOWN_DEADLINE")){
+		theSettings[SHUTDOWN_DEADLINE].assign(env_deadline);
+		mdclog_write(MDCLOG_INFO,"Shutdown deadline set to %s seconds from environment variable", theSettings[SHUTDOWN_DEADLINE].c_str());
+	}
+	if (const char *env_submgr = std::getenv("SUBMGR_ENDPOINT")){
+		theSettings[SUBMGR_ENDPOINT].assign(env_submgr);
+		mdclog_write(MDCLOG_INFO,"Submgr endpoint set to %s from environment variable", theSettings[SUBMGR_ENDPOINT].c_str());
+	}
+	if (const char *env_appmgr = std::getenv("APPMGR_ENDPOINT")){
+		theSettings[APPMGR_ENDPOINT].assign(env_appmgr);
+		mdclog_write(MDCLOG_INFO,"Appmgr endpoint set to %s from environment variable", theSettings[APPMGR_ENDPOINT].c_str());
+	}
+	if (const char *env_e2mgr = std::getenv("E2MGR_ENDPOINT")){
+		theSettings[E2MGR_ENDPOINT].assign(env_e2mgr);
+		mdclog_write(MDCLOG_INFO,"E2mgr endpoint set to %s from environment variable", theSettings[E2MGR_ENDPOINT].c_str());
+	}
 	if (const char *env_config_file = std::getenv("CONFIG_FILE")){
 		theSettings[CONFIG_FILE].assign(env_config_file);
 		mdclog_write(MDCLOG_INFO,"Config file set to %s from environment variable", theSettings[CONFIG_FILE].c_str());
@@ -31,6 +31,19 @@
 #define DEFAULT_HTTP_PORT "8080"
 #define DEFAULT_MSG_MAX_BUFFER "2072"
 #define DEFAULT_THREADS "1"
+#define DEFAULT_BUSY_POLL "0"	// 1: receivers and workers spin instead of sleeping in the kernel
+#define DEFAULT_CPU_AFFINITY ""	// cpus to pin receivers and workers to (e.g. "2,4-7"), empty: no pinning
+#define DEFAULT_SCHED_PRIORITY "0"	// SCHED_FIFO priority of receivers and workers, 0: default scheduler
+#define DEFAULT_RETRY_QUEUE_SIZE "1024"	// rmr messages waiting to be resent
+#define DEFAULT_RETRY_DROP_POLICY "oldest"	// oldest or newest message is dropped when the retry queue is full
+#define DEFAULT_RECEIVER_MODE "sharded"	// shared: all threads receive from rmr, sharded: one receiver dispatches by E2 node, pipeline: staged threads
+#define DEFAULT_PIPELINE_THREADS "1,1,1"	// decode,encode,send threads in pipeline mode
+#define DEFAULT_CONTROL_ENCODER "fast"	// fast: hand-written RIC control request encoder, asn1c: generic encoder
+#define DEFAULT_SUBSCRIPTION_CONCURRENCY "16"	// REST subscription requests in flight to submgr at startup and shutdown
+#define DEFAULT_SHUTDOWN_DEADLINE "20"	// seconds for deleting the subscriptions and deregistering, within the pod's grace period
+#define DEFAULT_SUBMGR_ENDPOINT "http://service-ricplt-submgr-http.ricplt.svc.cluster.local:8088"
+#define DEFAULT_APPMGR_ENDPOINT "http://service-ricplt-appmgr-http.ricplt.svc.cluster.local:8080"
+#define DEFAULT_E2MGR_ENDPOINT "http://service-ricplt-e2mgr-http.ricplt.svc.cluster.local:3800"
 
 #define DEFAULT_LOG_LEVEL	MDCLOG_WARN
 #define DEFAULT_CONFIG_FILE "/opt/ric/config/config-file.json"
@@ -39,6 +52,9 @@
 
 #define ASN_BUFF_MAX_SIZE		4096
 #define MAX_SUBSCRIPTION_ATTEMPTS	10
+#define SUBSCRIPTION_BACKOFF_MS		100	// first retry delay, doubled on every attempt
+#define SUBSCRIPTION_BACKOFF_MAX_MS	5000
+#define SUBSCRIPTION_CONFIRM_TIMEOUT	10	// seconds to wait at startup for the submgr notifications
 #define BOUNCER_POLICY_ID 2
 
 using namespace std;
@@ -53,6 +69,19 @@ public:
 		  BOUNCER_PORT,
 		  MSG_MAX_BUFFER,
 		  THREADS,
+		  BUSY_POLL,
+		  CPU_AFFINITY,
+		  SCHED_PRIORITY,
+		  RETRY_QUEUE_SIZE,
+		  RETRY_DROP_POLICY,
+		  RECEIVER_MODE,
+		  PIPELINE_THREADS,
+		  CONTROL_ENCODER,
+		  SUBSCRIPTION_CONCURRENCY,
+		  SHUTDOWN_DEADLINE,
+		  SUBMGR_ENDPOINT,
+		  APPMGR_ENDPOINT,
+		  E2MGR_ENDPOINT,
 		  LOG_LEVEL,
 		  CONFIG_FILE,
 		  CONFIG_STR,
@@ -0,0 +1,68 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+#include "xapp_control_plane.hpp"
+
+XappControlPlane::XappControlPlane(XappRmr *rmr, size_t queue_size): _queue(queue_size) {
+	_rmr = rmr;
+	_running.store(true);
+	sem_init(&_ready, 0, 0);
+}
+
+XappControlPlane::~XappControlPlane(void) {
+	rmr_mbuf_t *mbuf = NULL;
+
+	while (_queue.pop(mbuf)) {	// offered after the control loop had stopped
+		rmr_free_msg(mbuf);
+	}
+	sem_destroy(&_ready);
+}
+
+bool XappControlPlane::is_control(int mtype) {
+	switch (mtype) {
+		case RIC_SUB_RESP:
+		case RIC_SUB_FAILURE:
+		case RIC_SUB_DEL_RESP:
+		case RIC_SUB_DEL_FAILURE:
+		case A1_POLICY_REQ:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool XappControlPlane::offer(rmr_mbuf_t *mbuf) {
+	if (!is_control(mbuf->mtype)) {
+		return false;
+	}
+
+	if (!_queue.push(mbuf)) {
+		// better to stall this receiver for once than to lose a subscription response
+		mdclog_write(MDCLOG_WARN, "Control-plane queue is full, handling message of type %d on the receiver thread", mbuf->mtype);
+		return false;
+	}
+	sem_post(&_ready);
+	return true;
+}
+
+// Lets the control loop finish the messages already queued and return
+void XappControlPlane::stop(void) {
+	_running.store(false);
+	sem_post(&_ready);
+}
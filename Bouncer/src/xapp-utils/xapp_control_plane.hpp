@@ -0,0 +1,104 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+ * xapp_control_plane.hpp
+ *
+ * Moves control-plane messages off the receiver threads onto a thread of their own.
+ */
+
+#ifndef XAPP_UTILS_XAPP_CONTROL_PLANE_HPP_
+#define XAPP_UTILS_XAPP_CONTROL_PLANE_HPP_
+
+#include <semaphore.h>
+#include <atomic>
+
+#include "xapp_rmr.hpp"
+#include "xapp_queue.hpp"
+
+#define CONTROL_QUEUE_SIZE 256
+
+/*
+	Subscription responses and failures, and A1 policy requests, may block for a long time
+	in their handlers, so receiver threads hand them to the control-plane thread and go on
+	with indications. Health checks are cheap and are still answered by the receivers.
+	All receiver threads push to the same lock-free queue, which has a single consumer.
+*/
+class XappControlPlane {
+public:
+	XappControlPlane(XappRmr *rmr, size_t queue_size = CONTROL_QUEUE_SIZE);
+	~XappControlPlane(void);
+
+	XappControlPlane(XappControlPlane const &) = delete;
+	XappControlPlane& operator=(XappControlPlane const &) = delete;
+
+	static bool is_control(int mtype);
+
+	// Takes the message when it belongs to the control plane, the caller must not touch it afterwards
+	bool offer(rmr_mbuf_t *);
+
+	template <class MsgHandler>
+	void control_loop(MsgHandler);
+	void stop(void);
+
+	size_t get_queue_depth(void) const { return _queue.size(); }
+
+private:
+	XappRmr *_rmr;
+	MpmcQueue<rmr_mbuf_t *> _queue;
+	sem_t _ready;				// one post for each queued message, and one on stop
+	std::atomic<bool> _running;
+};
+
+template <class MsgHandler>
+void XappControlPlane::control_loop(MsgHandler msgproc) {
+	rmr_mbuf_t *mbuf = NULL;
+	bool resend = false;
+
+	mdclog_write(MDCLOG_INFO, "Starting control-plane thread");
+
+	while (true) {
+		xapp_sem_wait(&_ready, false);	// control messages are rare, never worth spinning for
+
+		if (!_queue.pop(mbuf)) {
+			if (!_running.load()) {
+				break;
+			}
+			sem_post(&_ready);	// claimed by a receiver that is still writing it, try again
+			std::this_thread::yield();
+			continue;
+		}
+
+		msgproc(mbuf, &resend);
+
+		if (resend) {
+			mdclog_write(MDCLOG_INFO,"RMR Return to Sender Message of Type: %d",mbuf->mtype);
+			mbuf = _rmr->xapp_rmr_rts(mbuf);
+			resend = false;
+		}
+
+		if (mbuf != NULL) {
+			rmr_free_msg(mbuf);
+		}
+	}
+
+	mdclog_write(MDCLOG_INFO, "Cleaned up control-plane thread");
+}
+
+#endif /* XAPP_UTILS_XAPP_CONTROL_PLANE_HPP_ */
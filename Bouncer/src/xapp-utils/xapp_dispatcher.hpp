@@ -0,0 +1,211 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+ * xapp_dispatcher.hpp
+ *
+ * Receives messages on a single RMR thread and shards them over a fixed set of workers.
+ */
+
+#ifndef XAPP_UTILS_XAPP_DISPATCHER_HPP_
+#define XAPP_UTILS_XAPP_DISPATCHER_HPP_
+
+#include <semaphore.h>
+#include <errno.h>
+#include <vector>
+#include <memory>
+#include <thread>
+
+#include "xapp_rmr.hpp"
+#include "xapp_queue.hpp"
+#include "xapp_latency.hpp"
+
+#define DISPATCH_QUEUE_SIZE 1024
+
+/*
+	All messages from the same E2 node (MEID) are always handed to the same worker,
+	so they are processed and answered in the order they were received, while
+	messages from different E2 nodes are processed in parallel.
+	The receive thread and each worker are connected by a lock-free SPSC queue.
+*/
+template <class MsgHandler>
+class XappDispatcher {
+public:
+	XappDispatcher(XappRmr *rmr, size_t workers, size_t queue_size = DISPATCH_QUEUE_SIZE);
+
+	XappDispatcher(XappDispatcher const &) = delete;
+	XappDispatcher& operator=(XappDispatcher const &) = delete;
+
+	void receive_loop(void);
+	void worker_loop(size_t, MsgHandler);
+
+	size_t get_num_workers(void) const { return _shards.size(); }
+	size_t get_queue_depth(size_t worker) const { return _shards[worker]->queue.size(); }
+
+private:
+	// a message along with the time it was received, so the time spent queued counts towards its latency
+	struct Dispatched {
+		rmr_mbuf_t *mbuf;
+		uint64_t received;
+	};
+
+	struct Shard {
+		Shard(size_t queue_size): queue(queue_size) { sem_init(&ready, 0, 0); }
+		~Shard() { sem_destroy(&ready); }
+
+		SpscQueue<Dispatched> queue;
+		sem_t ready;	// one post for each queued message, and one for wakeup on shutdown
+	};
+
+	size_t shard_of(rmr_mbuf_t *);
+
+	XappRmr *_rmr;
+	std::vector<std::unique_ptr<Shard>> _shards;
+};
+
+template <class MsgHandler>
+XappDispatcher<MsgHandler>::XappDispatcher(XappRmr *rmr, size_t workers, size_t queue_size) {
+	_rmr = rmr;
+	if (workers < 1) {
+		workers = 1;
+	}
+	for (size_t i = 0; i < workers; i++) {
+		_shards.emplace_back(new Shard(queue_size));
+	}
+}
+
+// FNV-1a over the MEID, or over the subscription id when the message carries no MEID
+template <class MsgHandler>
+size_t XappDispatcher<MsgHandler>::shard_of(rmr_mbuf_t *mbuf) {
+	unsigned char meid[RMR_MAX_MEID] = {0, };
+	uint64_t hash = 14695981039346656037ULL;
+
+	if (rmr_get_meid(mbuf, meid) != NULL && meid[0] != '\0') {
+		for (int i = 0; i < RMR_MAX_MEID && meid[i] != '\0'; i++) {
+			hash ^= meid[i];
+			hash *= 1099511628211ULL;
+		}
+	} else {
+		hash ^= (uint32_t) mbuf->sub_id;	// all indications of a RIC request share the same subscription id
+		hash *= 1099511628211ULL;
+	}
+
+	return hash % _shards.size();
+}
+
+template <class MsgHandler>
+void XappDispatcher<MsgHandler>::receive_loop(void) {
+	rmr_mbuf_t *mbuf = NULL;
+
+	if(!_rmr->get_is_ready()){
+		mdclog_write( MDCLOG_ERR, "RMR Shows Not Ready in DISPATCHER, file= %s, line=%d ",__FILE__,__LINE__);
+		return;
+	}
+	assert(_rmr->get_rmr_context() != NULL);
+
+	mdclog_write(MDCLOG_INFO, "Starting dispatcher receive thread for %lu workers", _shards.size());
+
+	while(_rmr->get_listen()) {
+		mbuf = _rmr->xapp_rmr_rcv(mbuf);	// also returns when set_listen(false) is called
+
+		if (mbuf == NULL || mbuf->state == RMR_ERR_TIMEOUT) {
+			continue;
+		}
+
+		if( mbuf->mtype < 0 || mbuf->state != RMR_OK ) {
+			mdclog_write(MDCLOG_ERR, "bad msg:  state=%d  errno=%d, file= %s, line=%d", mbuf->state, errno, __FILE__,__LINE__ );
+			continue;
+		}
+
+		metrics_received(mbuf->mtype);
+
+		if (_rmr->offer_control_plane(mbuf)) {
+			mbuf = NULL;	// now owned by the control plane
+			continue;
+		}
+
+		Shard *shard = _shards[shard_of(mbuf)].get();
+		Dispatched item = { mbuf, latency_clock() };
+		while (!shard->queue.push(item)) {	// worker is lagging behind, wait for it to preserve ordering
+			if (!_rmr->get_listen()) {
+				break;
+			}
+			std::this_thread::yield();
+		}
+		if (!_rmr->get_listen()) {
+			break;	// mbuf was not queued, released below
+		}
+
+		sem_post(&shard->ready);
+		mbuf = NULL;	// now owned by the worker, rmr allocates a new buffer on the next receive
+	}
+
+	if (mbuf != NULL) {
+		rmr_free_msg(mbuf);
+	}
+
+	for (auto &shard : _shards) {	// wake up all workers so that they can check for get_listen()
+		sem_post(&shard->ready);
+	}
+
+	mdclog_write(MDCLOG_INFO, "Cleaned up dispatcher receive thread");
+}
+
+template <class MsgHandler>
+void XappDispatcher<MsgHandler>::worker_loop(size_t worker, MsgHandler msgproc) {
+	Shard *shard = _shards[worker].get();
+	Dispatched item;
+	rmr_mbuf_t *mbuf = NULL;
+	latency_stamps stamps;
+	bool resend = false;
+	bool busy_poll = _rmr->get_busy_poll();
+
+	mdclog_write(MDCLOG_INFO, "Starting dispatcher worker %lu", worker);
+
+	while (true) {
+		xapp_sem_wait(&shard->ready, busy_poll);
+
+		if (!shard->queue.pop(item)) {
+			if (!_rmr->get_listen()) {
+				break;	// queue has been drained
+			}
+			continue;
+		}
+		mbuf = item.mbuf;
+
+		stamps.clear();
+		stamps.received = item.received;
+		msgproc(mbuf, &resend, &stamps);
+
+		if (resend) {
+			mdclog_write(MDCLOG_INFO,"RMR Return to Sender Message of Type: %d",mbuf->mtype);
+			mbuf = _rmr->xapp_rmr_rts(mbuf);
+			stamps.record_sent();
+			resend = false;
+		}
+
+		if (mbuf != NULL) {
+			rmr_free_msg(mbuf);
+		}
+	}
+
+	mdclog_write(MDCLOG_INFO, "Cleaned up dispatcher worker %lu", worker);
+}
+
+#endif /* XAPP_UTILS_XAPP_DISPATCHER_HPP_ */
@@ -0,0 +1,54 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+#include <stdexcept>
+#include <chrono>
+#include <mdclog/mdclog.h>
+
+#include "xapp_http_pool.hpp"
+
+using namespace web;
+using namespace web::http::client;
+
+XappHttpPool::XappHttpPool(const std::string endpoints[HTTP_NUM_SERVICES], int timeout) {
+	http_client_config config;
+	config.set_timeout(std::chrono::seconds(timeout));
+
+	for (int i = 0; i < HTTP_NUM_SERVICES; i++) {
+		if (!uri::validate(endpoints[i])) {
+			throw std::invalid_argument(std::string("invalid ") + service_name((http_service_t) i) + " endpoint: " + endpoints[i]);
+		}
+		_endpoints[i] = endpoints[i];
+		_clients[i].reset(new http_client(uri(endpoints[i]), config));	// connects on the first request
+		mdclog_write(MDCLOG_INFO, "Using %s at %s", service_name((http_service_t) i), endpoints[i].c_str());
+	}
+}
+
+const char *XappHttpPool::service_name(http_service_t service) {
+	switch (service) {
+		case HTTP_SUBMGR:
+			return "submgr";
+		case HTTP_APPMGR:
+			return "appmgr";
+		case HTTP_E2MGR:
+			return "e2mgr";
+		default:
+			return "unknown";
+	}
+}
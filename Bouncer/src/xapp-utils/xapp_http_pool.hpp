@@ -0,0 +1,67 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+ * xapp_http_pool.hpp
+ *
+ * Long-lived REST clients to the RIC platform services.
+ */
+
+#ifndef XAPP_UTILS_XAPP_HTTP_POOL_HPP_
+#define XAPP_UTILS_XAPP_HTTP_POOL_HPP_
+
+#include <string>
+#include <memory>
+#include <cpprest/http_client.h>
+
+#define HTTP_CLIENT_TIMEOUT 30	// seconds
+
+typedef enum {
+	HTTP_SUBMGR,
+	HTTP_APPMGR,
+	HTTP_E2MGR,
+	HTTP_NUM_SERVICES
+} http_service_t;
+
+/*
+	One client per platform service, shared by every request to it. A cpprest client keeps
+	its connections open between requests and opens a new one for each concurrent request,
+	so requests skip the DNS lookup and TCP setup once the service has been reached. cpprest
+	does not pipeline requests on a connection. The clients are thread safe and live as long
+	as the pool.
+*/
+class XappHttpPool {
+public:
+	XappHttpPool(const std::string endpoints[HTTP_NUM_SERVICES], int timeout = HTTP_CLIENT_TIMEOUT);
+
+	XappHttpPool(XappHttpPool const &) = delete;
+	XappHttpPool& operator=(XappHttpPool const &) = delete;
+
+	// Requests take the path relative to the endpoint, e.g. /ric/v1/subscriptions
+	web::http::client::http_client &client(http_service_t service) { return *_clients[service]; }
+	const std::string &endpoint(http_service_t service) const { return _endpoints[service]; }
+
+	static const char *service_name(http_service_t);
+
+private:
+	std::string _endpoints[HTTP_NUM_SERVICES];
+	std::unique_ptr<web::http::client::http_client> _clients[HTTP_NUM_SERVICES];
+};
+
+#endif /* XAPP_UTILS_XAPP_HTTP_POOL_HPP_ */
@@ -0,0 +1,161 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+#include "xapp_latency.hpp"
+#include <math.h>
+#include <mutex>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+
+void LatencyHistogram::reset(void) {
+	for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+		_counts[i].store(0, std::memory_order_relaxed);
+	}
+	_count.store(0, std::memory_order_relaxed);
+	_sum.store(0, std::memory_order_relaxed);
+	_max.store(0, std::memory_order_relaxed);
+}
+
+// Only this histogram must not be written meanwhile, the other one may be recorded into by its thread
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+	uint64_t count = 0;
+	for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+		uint64_t n = other._counts[i].load(std::memory_order_relaxed);
+		add(_counts[i], n);
+		count += n;
+	}
+	// the total is taken from the buckets, so that it matches them even while other is written to
+	add(_count, count);
+	add(_sum, other.get_sum());
+	if (other.get_max() > get_max()) {
+		_max.store(other.get_max(), std::memory_order_relaxed);
+	}
+}
+
+uint64_t LatencyHistogram::bucket_highest(size_t bucket) {
+	if (bucket < LATENCY_SUB_BUCKETS) {
+		return bucket;
+	}
+	int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+	uint64_t lowest = (uint64_t) (bucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS) << shift;
+	return lowest + ((uint64_t) 1 << shift) - 1;
+}
+
+// Highest value of the bucket holding the given percentile (0 to 100), never above the recorded maximum
+uint64_t LatencyHistogram::percentile(double p) const {
+	uint64_t count = get_count();
+	if (count == 0) {
+		return 0;
+	}
+
+	uint64_t rank = (uint64_t) ceil(p / 100.0 * count);
+	if (rank < 1) {
+		rank = 1;
+	}
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+		seen += _counts[i].load(std::memory_order_relaxed);
+		if (seen >= rank) {
+			uint64_t highest = bucket_highest(i);
+			return highest < get_max() ? highest : get_max();
+		}
+	}
+	return get_max();
+}
+
+// Values recorded in buckets that lie entirely at or below ns
+uint64_t LatencyHistogram::count_at_most(uint64_t ns) const {
+	uint64_t count = 0;
+	for (size_t i = 0; i < LATENCY_BUCKETS && bucket_highest(i) <= ns; i++) {
+		count += _counts[i].load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+void latency_stamps::record_sent(void) {
+	if (received == 0 || decoded == 0 || encoded == 0) {
+		return;
+	}
+
+	uint64_t sent = latency_clock();
+	LatencyHistogram *stages = latency_thread_histograms();
+	stages[LATENCY_RECEIVE_DECODE].record(decoded - received);
+	stages[LATENCY_DECODE_ENCODE].record(encoded - decoded);
+	stages[LATENCY_ENCODE_SEND].record(sent - encoded);
+}
+
+/*
+	Every thread that records gets histograms of its own, registered once under the lock.
+	They are never freed, so the messages of threads that have ended still count, and a
+	snapshot never races with a thread exiting.
+*/
+static std::mutex latency_registry_lock;
+static std::vector<LatencyHistogram *> latency_registry;
+
+LatencyHistogram *latency_thread_histograms(void) {
+	static thread_local LatencyHistogram *stages = NULL;
+
+	if (stages == NULL) {
+		stages = new LatencyHistogram[LATENCY_NUM_STAGES];
+		std::lock_guard<std::mutex> guard(latency_registry_lock);
+		latency_registry.push_back(stages);
+	}
+	return stages;
+}
+
+void latency_snapshot(latency_stage_t stage, LatencyHistogram &snapshot) {
+	std::lock_guard<std::mutex> guard(latency_registry_lock);
+
+	snapshot.reset();
+	for (LatencyHistogram *stages : latency_registry) {
+		snapshot.merge(stages[stage]);
+	}
+}
+
+const char *latency_stage_name(latency_stage_t stage) {
+	switch (stage) {
+		case LATENCY_RECEIVE_DECODE:
+			return "receive_decode";
+		case LATENCY_DECODE_ENCODE:
+			return "decode_encode";
+		case LATENCY_ENCODE_SEND:
+			return "encode_send";
+		default:
+			return "unknown";
+	}
+}
+
+// Count and percentiles of a stage in microseconds, merged over all threads
+std::string latency_report(latency_stage_t stage) {
+	std::stringstream ss;
+	LatencyHistogram snapshot;
+
+	latency_snapshot(stage, snapshot);
+
+	ss << std::fixed << std::setprecision(1);
+	ss << "Latency " << latency_stage_name(stage) << ": count=" << snapshot.get_count()
+			<< " p50=" << snapshot.percentile(50) / 1000.0
+			<< " p90=" << snapshot.percentile(90) / 1000.0
+			<< " p99=" << snapshot.percentile(99) / 1000.0
+			<< " p99.9=" << snapshot.percentile(99.9) / 1000.0
+			<< " max=" << snapshot.get_max() / 1000.0 << " us";
+	return ss.str();
+}
@@ -0,0 +1,131 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+ * xapp_latency.hpp
+ *
+ * Per stage latency histograms of the messages answered by the receiver threads.
+ */
+
+#ifndef XAPP_UTILS_XAPP_LATENCY_HPP_
+#define XAPP_UTILS_XAPP_LATENCY_HPP_
+
+#include <time.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#define LATENCY_SUB_BUCKET_BITS 5	// 32 buckets per power of two, so a value is recorded within 1/32 of itself
+#define LATENCY_MAX_BITS 40			// latencies of 2^40 ns (about 18 minutes) and above share the last bucket
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKETS ((LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+typedef enum {
+	LATENCY_RECEIVE_DECODE = 0,		// from rmr receive to the decoded indication, includes any queueing in between
+	LATENCY_DECODE_ENCODE,			// from the decoded indication to the encoded control request
+	LATENCY_ENCODE_SEND,			// from the encoded control request until it has been handed to rmr
+	LATENCY_NUM_STAGES
+} latency_stage_t;
+
+// Nanoseconds on the monotonic clock, read from the vdso without a system call
+static inline uint64_t latency_clock(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/*
+	Log-linear histogram of latencies in nanoseconds, laid out like an HdrHistogram.
+	A histogram has a single writer, so counters are updated with relaxed loads and
+	stores rather than atomic read-modify-writes, while any other thread may read
+	them at the same time to merge a snapshot.
+*/
+class LatencyHistogram {
+public:
+	LatencyHistogram(void) { reset(); };
+
+	LatencyHistogram(LatencyHistogram const &) = delete;
+	LatencyHistogram& operator=(LatencyHistogram const &) = delete;
+
+	void record(uint64_t ns) {
+		add(_counts[bucket_of(ns)], 1);
+		add(_count, 1);
+		add(_sum, ns);
+		if (ns > _max.load(std::memory_order_relaxed)) {
+			_max.store(ns, std::memory_order_relaxed);
+		}
+	};
+
+	void merge(const LatencyHistogram &);
+	void reset(void);
+
+	uint64_t get_count(void) const { return _count.load(std::memory_order_relaxed); };
+	uint64_t get_sum(void) const { return _sum.load(std::memory_order_relaxed); };
+	uint64_t get_max(void) const { return _max.load(std::memory_order_relaxed); };
+	uint64_t percentile(double) const;
+	uint64_t count_at_most(uint64_t ns) const;
+
+	static size_t bucket_of(uint64_t ns) {
+		if (ns < LATENCY_SUB_BUCKETS) {
+			return ns;
+		}
+		int shift = 63 - __builtin_clzll(ns) - LATENCY_SUB_BUCKET_BITS;
+		if (shift > LATENCY_MAX_BITS - LATENCY_SUB_BUCKET_BITS - 1) {
+			return LATENCY_BUCKETS - 1;
+		}
+		return (shift + 1) * LATENCY_SUB_BUCKETS + (ns >> shift) - LATENCY_SUB_BUCKETS;
+	};
+	static uint64_t bucket_highest(size_t);
+
+private:
+	static void add(std::atomic<uint64_t> &counter, uint64_t value) {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	};
+
+	std::atomic<uint64_t> _counts[LATENCY_BUCKETS];
+	std::atomic<uint64_t> _count;
+	std::atomic<uint64_t> _sum;
+	std::atomic<uint64_t> _max;
+};
+
+/*
+	Time at which a message reached each stage boundary, zero for the ones it did not pass.
+	Only messages that passed all of them, i.e. answered indications, are recorded.
+*/
+struct latency_stamps {
+	latency_stamps(): received(0), decoded(0), encoded(0) {};
+
+	void clear(void) { received = decoded = encoded = 0; };
+	void record_sent(void);	// into the histograms of the calling thread
+
+	uint64_t received;
+	uint64_t decoded;
+	uint64_t encoded;
+};
+
+// Histograms of the calling thread, created on first use and kept after the thread has ended
+LatencyHistogram *latency_thread_histograms(void);
+
+// Merges the histograms of all threads for a stage, on demand and without stopping the writers
+void latency_snapshot(latency_stage_t, LatencyHistogram &);
+const char *latency_stage_name(latency_stage_t);
+std::string latency_report(latency_stage_t);
+
+#endif /* XAPP_UTILS_XAPP_LATENCY_HPP_ */
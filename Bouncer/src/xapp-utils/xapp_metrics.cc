@@ -0,0 +1,163 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+#include "xapp_metrics.hpp"
+#include "xapp_latency.hpp"
+#include <mutex>
+#include <vector>
+#include <map>
+#include <ios>
+
+// upper bounds of the exported latency buckets, the recorded histograms are much finer
+static const uint64_t latency_bounds_ns[] = {
+	1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+	1000000, 2500000, 5000000, 10000000, 25000000, 50000000, 100000000, 250000000, 1000000000
+};
+
+static void clear_mtype(thread_metrics::mtype_counters &slot) {
+	slot.mtype.store(-1, std::memory_order_relaxed);
+	slot.received.store(0, std::memory_order_relaxed);
+	slot.sent.store(0, std::memory_order_relaxed);
+}
+
+thread_metrics::thread_metrics() {
+	for (int i = 0; i < METRIC_NUM_COUNTERS; i++) {
+		counters[i].store(0, std::memory_order_relaxed);
+	}
+	for (int i = 0; i < METRICS_MTYPE_SLOTS; i++) {
+		clear_mtype(types[i]);
+	}
+	clear_mtype(other);
+}
+
+// Open addressing on the message type, a slot is claimed by the first message of its type
+thread_metrics::mtype_counters &metrics_mtype(thread_metrics *metrics, int mtype) {
+	if (mtype < 0) {
+		return metrics->other;
+	}
+
+	for (int i = 0; i < METRICS_MTYPE_SLOTS; i++) {
+		thread_metrics::mtype_counters &slot = metrics->types[(mtype + i) % METRICS_MTYPE_SLOTS];
+		int current = slot.mtype.load(std::memory_order_relaxed);
+		if (current == mtype) {
+			return slot;
+		}
+		if (current == -1) {
+			slot.mtype.store(mtype, std::memory_order_release);	// readers only sum slots whose type they have seen
+			return slot;
+		}
+	}
+	return metrics->other;
+}
+
+/*
+	Registered once per thread under the lock and never freed, like the latency histograms,
+	so scrapes still see the counts of threads that have ended.
+*/
+static std::mutex metrics_registry_lock;
+static std::vector<thread_metrics *> metrics_registry;
+
+thread_metrics *metrics_thread_counters(void) {
+	static thread_local thread_metrics *metrics = NULL;
+
+	if (metrics == NULL) {
+		metrics = new thread_metrics();
+		std::lock_guard<std::mutex> guard(metrics_registry_lock);
+		metrics_registry.push_back(metrics);
+	}
+	return metrics;
+}
+
+void metrics_write_header(std::ostream &out, const char *name, const char *type, const char *help) {
+	out << "# HELP " << name << " " << help << "\n";
+	out << "# TYPE " << name << " " << type << "\n";
+}
+
+static void write_mtype_counter(std::ostream &out, const char *name, const std::map<int, uint64_t> &counts, uint64_t other) {
+	for (auto &count : counts) {
+		out << name << "{mtype=\"" << count.first << "\"} " << count.second << "\n";
+	}
+	out << name << "{mtype=\"other\"} " << other << "\n";
+}
+
+void metrics_write_counters(std::ostream &out) {
+	uint64_t counters[METRIC_NUM_COUNTERS] = {0, };
+	std::map<int, uint64_t> received;
+	std::map<int, uint64_t> sent;
+	uint64_t other_received = 0;
+	uint64_t other_sent = 0;
+
+	{
+		std::lock_guard<std::mutex> guard(metrics_registry_lock);
+
+		for (thread_metrics *metrics : metrics_registry) {
+			for (int i = 0; i < METRIC_NUM_COUNTERS; i++) {
+				counters[i] += metrics->counters[i].load(std::memory_order_relaxed);
+			}
+			for (int i = 0; i < METRICS_MTYPE_SLOTS; i++) {
+				thread_metrics::mtype_counters &slot = metrics->types[i];
+				int mtype = slot.mtype.load(std::memory_order_acquire);
+				if (mtype == -1) {
+					continue;
+				}
+				received[mtype] += slot.received.load(std::memory_order_relaxed);
+				sent[mtype] += slot.sent.load(std::memory_order_relaxed);
+			}
+			other_received += metrics->other.received.load(std::memory_order_relaxed);
+			other_sent += metrics->other.sent.load(std::memory_order_relaxed);
+		}
+	}
+
+	metrics_write_header(out, "xapp_messages_received_total", "counter", "RMR messages received, by message type.");
+	write_mtype_counter(out, "xapp_messages_received_total", received, other_received);
+
+	metrics_write_header(out, "xapp_messages_sent_total", "counter", "RMR messages sent or returned to sender, by message type.");
+	write_mtype_counter(out, "xapp_messages_sent_total", sent, other_sent);
+
+	metrics_write_header(out, "xapp_decode_errors_total", "counter", "Indications that could not be decoded.");
+	out << "xapp_decode_errors_total " << counters[METRIC_DECODE_ERRORS] << "\n";
+
+	metrics_write_header(out, "xapp_encode_errors_total", "counter", "Control requests that could not be encoded.");
+	out << "xapp_encode_errors_total " << counters[METRIC_ENCODE_ERRORS] << "\n";
+
+	metrics_write_header(out, "xapp_rmr_send_failures_total", "counter", "RMR sends that failed on the first attempt.");
+	out << "xapp_rmr_send_failures_total " << counters[METRIC_SEND_FAILURES] << "\n";
+}
+
+void metrics_write_latency(std::ostream &out) {
+	LatencyHistogram snapshot;
+	std::streamsize precision = out.precision(9);
+
+	metrics_write_header(out, "xapp_latency_seconds", "histogram", "Latency of answered indications, by processing stage.");
+
+	for (int stage = 0; stage < LATENCY_NUM_STAGES; stage++) {
+		const char *name = latency_stage_name((latency_stage_t) stage);
+		latency_snapshot((latency_stage_t) stage, snapshot);
+
+		for (uint64_t bound : latency_bounds_ns) {
+			out << "xapp_latency_seconds_bucket{stage=\"" << name << "\",le=\"" << bound / 1e9 << "\"} "
+					<< snapshot.count_at_most(bound) << "\n";
+		}
+		out << "xapp_latency_seconds_bucket{stage=\"" << name << "\",le=\"+Inf\"} " << snapshot.get_count() << "\n";
+		out << "xapp_latency_seconds_sum{stage=\"" << name << "\"} " << snapshot.get_sum() / 1e9 << "\n";
+		out << "xapp_latency_seconds_count{stage=\"" << name << "\"} " << snapshot.get_count() << "\n";
+	}
+
+	out.precision(precision);
+}
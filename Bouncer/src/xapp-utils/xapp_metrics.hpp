@@ -0,0 +1,94 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+ * xapp_metrics.hpp
+ *
+ * Message counters of the xapp threads and their Prometheus text exposition.
+ */
+
+#ifndef XAPP_UTILS_XAPP_METRICS_HPP_
+#define XAPP_UTILS_XAPP_METRICS_HPP_
+
+#include <stdint.h>
+#include <atomic>
+#include <ostream>
+
+#include "xapp_queue.hpp"
+
+#define METRICS_MTYPE_SLOTS 64	// distinct message types counted per thread, any further type is counted as other
+
+typedef enum {
+	METRIC_DECODE_ERRORS = 0,
+	METRIC_ENCODE_ERRORS,
+	METRIC_SEND_FAILURES,		// rmr sends and returns to sender that did not succeed on the first attempt
+	METRIC_NUM_COUNTERS
+} metric_counter_t;
+
+/*
+	Counters of a single thread. Only the owning thread writes them, with relaxed loads and
+	stores, and they are padded to whole cache lines so that threads never share a line.
+	A scrape sums the counters of all threads without stopping them.
+*/
+struct thread_metrics {
+	thread_metrics();
+
+	thread_metrics(thread_metrics const &) = delete;
+	thread_metrics& operator=(thread_metrics const &) = delete;
+
+	struct mtype_counters {
+		std::atomic<int> mtype;		// -1 while the slot is free
+		std::atomic<uint64_t> received;
+		std::atomic<uint64_t> sent;
+	};
+
+	char _pad0[XAPP_CACHE_LINE];
+	std::atomic<uint64_t> counters[METRIC_NUM_COUNTERS];
+	mtype_counters types[METRICS_MTYPE_SLOTS];
+	mtype_counters other;
+	char _pad1[XAPP_CACHE_LINE];
+};
+
+// Counters of the calling thread, created on first use and kept after the thread has ended
+thread_metrics *metrics_thread_counters(void);
+
+static inline void metrics_add(std::atomic<uint64_t> &counter, uint64_t value) {
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static inline void metrics_count(metric_counter_t counter) {
+	metrics_add(metrics_thread_counters()->counters[counter], 1);
+}
+
+thread_metrics::mtype_counters &metrics_mtype(thread_metrics *, int);
+
+static inline void metrics_received(int mtype) {
+	metrics_add(metrics_mtype(metrics_thread_counters(), mtype).received, 1);
+}
+
+static inline void metrics_sent(int mtype) {
+	metrics_add(metrics_mtype(metrics_thread_counters(), mtype).sent, 1);
+}
+
+// Prometheus text format
+void metrics_write_header(std::ostream &, const char *name, const char *type, const char *help);
+void metrics_write_counters(std::ostream &);
+void metrics_write_latency(std::ostream &);
+
+#endif /* XAPP_UTILS_XAPP_METRICS_HPP_ */
@@ -0,0 +1,216 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+#include "xapp_pipeline.hpp"
+#include <errno.h>
+#include <thread>
+
+XappPipeline::Stage::Stage(size_t queue_size, int num_threads): queue(queue_size) {
+	threads = num_threads < 1 ? 1 : num_threads;
+	running.store(threads);
+	done.store(false);
+	sem_init(&ready, 0, 0);
+}
+
+XappPipeline::Stage::~Stage() {
+	sem_destroy(&ready);
+}
+
+XappPipeline::XappPipeline(XappRmr *rmr, int decode_threads, int encode_threads, int send_threads, size_t queue_size):
+		_free_items(queue_size) {
+	_rmr = rmr;
+
+	_stages[PIPELINE_DECODE].reset(new Stage(queue_size, decode_threads));
+	_stages[PIPELINE_ENCODE].reset(new Stage(queue_size, encode_threads));
+	_stages[PIPELINE_SEND].reset(new Stage(queue_size, send_threads));
+
+	// every ring can hold all items, so queueing to the next stage never blocks
+	_num_items = _free_items.capacity();
+	_items.reset(new pipeline_item[_num_items]);
+	for (size_t i = 0; i < _num_items; i++) {
+		_free_items.push(&_items[i]);
+	}
+}
+
+void XappPipeline::put(pipeline_stage_t stage, pipeline_item *item) {
+	Stage *next = _stages[stage].get();
+	while (!next->queue.push(item)) {
+		std::this_thread::yield();
+	}
+	sem_post(&next->ready);
+}
+
+// Blocks until an item is available, returns false once upstream is done and the ring is drained
+bool XappPipeline::get(pipeline_stage_t stage, pipeline_item *&item) {
+	Stage *current = _stages[stage].get();
+
+	xapp_sem_wait(&current->ready, _rmr->get_busy_poll());
+
+	while (!current->queue.pop(item)) {
+		if (current->done.load()) {
+			// no producer is left, hence a failed pop really means the ring is empty
+			return current->queue.pop(item);
+		}
+		std::this_thread::yield();	// the item is still being published
+	}
+
+	return true;
+}
+
+// Tells the threads of a stage that no further items will be queued
+void XappPipeline::finish(pipeline_stage_t stage) {
+	Stage *next = _stages[stage].get();
+	next->done.store(true);
+	for (int i = 0; i < next->threads; i++) {
+		sem_post(&next->ready);
+	}
+}
+
+// The last thread to leave a stage shuts down the next one
+void XappPipeline::leave(pipeline_stage_t stage) {
+	if (_stages[stage]->running.fetch_sub(1) == 1 && stage + 1 < PIPELINE_NUM_STAGES) {
+		finish((pipeline_stage_t)(stage + 1));
+	}
+}
+
+void XappPipeline::receive_loop(void) {
+	rmr_mbuf_t *mbuf = NULL;
+	pipeline_item *item = NULL;
+	uint64_t received;
+
+	if(!_rmr->get_is_ready()){
+		mdclog_write( MDCLOG_ERR, "RMR Shows Not Ready in PIPELINE, file= %s, line=%d ",__FILE__,__LINE__);
+		finish(PIPELINE_DECODE);
+		return;
+	}
+	assert(_rmr->get_rmr_context() != NULL);
+
+	mdclog_write(MDCLOG_INFO, "Starting pipeline receive thread with %d decode, %d encode and %d send threads",
+			get_threads(PIPELINE_DECODE), get_threads(PIPELINE_ENCODE), get_threads(PIPELINE_SEND));
+
+	while(_rmr->get_listen()) {
+		mbuf = _rmr->xapp_rmr_rcv(mbuf);	// also returns when set_listen(false) is called
+
+		if (mbuf == NULL || mbuf->state == RMR_ERR_TIMEOUT) {
+			continue;
+		}
+
+		if( mbuf->mtype < 0 || mbuf->state != RMR_OK ) {
+			mdclog_write(MDCLOG_ERR, "bad msg:  state=%d  errno=%d, file= %s, line=%d", mbuf->state, errno, __FILE__,__LINE__ );
+			continue;
+		}
+		received = latency_clock();
+		metrics_received(mbuf->mtype);
+
+		if (_rmr->offer_control_plane(mbuf)) {
+			mbuf = NULL;	// now owned by the control plane
+			continue;
+		}
+
+		while (!_free_items.pop(item)) {	// all items are in flight, wait for the send stage to return one
+			if (!_rmr->get_listen()) {
+				break;
+			}
+			std::this_thread::yield();
+		}
+		if (!_rmr->get_listen()) {
+			break;	// mbuf was not queued, released below
+		}
+
+		item->mbuf = mbuf;
+		item->resend = false;
+		item->stamps.clear();
+		item->stamps.received = received;
+		put(PIPELINE_DECODE, item);
+		mbuf = NULL;	// now owned by the pipeline, rmr allocates a new buffer on the next receive
+	}
+
+	if (mbuf != NULL) {
+		rmr_free_msg(mbuf);
+	}
+
+	finish(PIPELINE_DECODE);
+
+	mdclog_write(MDCLOG_INFO, "Cleaned up pipeline receive thread");
+}
+
+// Decodes indications and runs the decision, any other message is handled in full here
+void XappPipeline::decode_loop(XappMsgHandler msgproc) {
+	pipeline_item *item = NULL;
+
+	while (get(PIPELINE_DECODE, item)) {
+		if (item->mbuf->mtype == RIC_INDICATION) {
+			if (msgproc.decode_indication(item->mbuf, item->ctx)) {
+				item->stamps.decoded = latency_clock();
+				put(PIPELINE_ENCODE, item);
+				continue;
+			}
+			msgproc.release_indication(item->ctx);
+
+		} else {
+			msgproc(item->mbuf, &item->resend);
+		}
+
+		put(PIPELINE_SEND, item);
+	}
+
+	leave(PIPELINE_DECODE);
+}
+
+void XappPipeline::encode_loop(XappMsgHandler msgproc) {
+	pipeline_item *item = NULL;
+
+	while (get(PIPELINE_ENCODE, item)) {
+		item->resend = msgproc.encode_control_request(item->mbuf, item->ctx);
+		if (item->resend) {
+			item->stamps.encoded = latency_clock();
+		}
+		msgproc.release_indication(item->ctx);
+
+		put(PIPELINE_SEND, item);
+	}
+
+	leave(PIPELINE_ENCODE);
+}
+
+void XappPipeline::send_loop(void) {
+	pipeline_item *item = NULL;
+
+	while (get(PIPELINE_SEND, item)) {
+		rmr_mbuf_t *mbuf = item->mbuf;
+
+		if (item->resend) {
+			mdclog_write(MDCLOG_INFO,"RMR Return to Sender Message of Type: %d",mbuf->mtype);
+			mbuf = _rmr->xapp_rmr_rts(mbuf);
+			item->stamps.record_sent();
+		}
+
+		if (mbuf != NULL) {
+			rmr_free_msg(mbuf);
+		}
+
+		item->mbuf = NULL;
+		item->resend = false;
+		_free_items.push(item);
+	}
+
+	leave(PIPELINE_SEND);
+
+	mdclog_write(MDCLOG_INFO, "Cleaned up pipeline send thread");
+}
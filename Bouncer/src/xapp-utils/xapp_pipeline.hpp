@@ -0,0 +1,106 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+ * xapp_pipeline.hpp
+ *
+ * Staged processing of rmr messages: receive -> decode (and decide) -> encode -> send
+ */
+
+#ifndef XAPP_UTILS_XAPP_PIPELINE_HPP_
+#define XAPP_UTILS_XAPP_PIPELINE_HPP_
+
+#include <semaphore.h>
+#include <atomic>
+#include <memory>
+
+#include "xapp_rmr.hpp"
+#include "xapp_queue.hpp"
+#include "xapp_latency.hpp"
+#include "msgs_proc.hpp"
+
+#define PIPELINE_QUEUE_SIZE 1024
+
+typedef enum {
+	PIPELINE_DECODE = 0,
+	PIPELINE_ENCODE,
+	PIPELINE_SEND,
+	PIPELINE_NUM_STAGES
+} pipeline_stage_t;
+
+// The asn1c memory of an indication moves between stage threads, so each item carries its own arena
+struct pipeline_item {
+	pipeline_item(): mbuf(NULL), resend(false) { ctx.arena = &arena; };
+	~pipeline_item() { asn_arena_destroy(&arena); };
+
+	pipeline_item(pipeline_item const &) = delete;
+	pipeline_item& operator=(pipeline_item const &) = delete;
+
+	rmr_mbuf_t *mbuf;
+	indication_context ctx;
+	asn_arena_t arena = ASN_ARENA_INITIALIZER;
+	latency_stamps stamps;
+	bool resend;
+};
+
+/*
+	Each stage runs on its own set of threads, and stages are connected by bounded
+	lock-free rings, so decoding and encoding of different indications overlap.
+	Messages are only guaranteed to be answered in order when every stage runs a single thread.
+*/
+class XappPipeline {
+public:
+	XappPipeline(XappRmr *rmr, int decode_threads, int encode_threads, int send_threads, size_t queue_size = PIPELINE_QUEUE_SIZE);
+
+	XappPipeline(XappPipeline const &) = delete;
+	XappPipeline& operator=(XappPipeline const &) = delete;
+
+	void receive_loop(void);
+	void decode_loop(XappMsgHandler);
+	void encode_loop(XappMsgHandler);
+	void send_loop(void);
+
+	int get_threads(pipeline_stage_t stage) const { return _stages[stage]->threads; }
+	size_t get_queue_depth(pipeline_stage_t stage) const { return _stages[stage]->queue.size(); }
+
+private:
+	struct Stage {
+		Stage(size_t queue_size, int num_threads);
+		~Stage();
+
+		MpmcQueue<pipeline_item *> queue;
+		sem_t ready;					// one post for each queued item, and one per thread on shutdown
+		int threads;
+		std::atomic<int> running;		// threads of this stage that have not finished yet
+		std::atomic<bool> done;			// upstream will not queue any further item
+	};
+
+	void put(pipeline_stage_t, pipeline_item *);
+	bool get(pipeline_stage_t, pipeline_item *&);
+	void finish(pipeline_stage_t);
+	void leave(pipeline_stage_t);
+
+	XappRmr *_rmr;
+	size_t _num_items;
+	std::unique_ptr<pipeline_item[]> _items;
+	MpmcQueue<pipeline_item *> _free_items;
+	std::unique_ptr<Stage> _stages[PIPELINE_NUM_STAGES];
+};
+
+#endif /* XAPP_UTILS_XAPP_PIPELINE_HPP_ */
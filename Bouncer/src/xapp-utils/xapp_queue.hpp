@@ -0,0 +1,219 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+ * xapp_queue.hpp
+ *
+ * Bounded lock-free queues used to hand messages between xapp threads.
+ */
+
+#ifndef XAPP_UTILS_XAPP_QUEUE_HPP_
+#define XAPP_UTILS_XAPP_QUEUE_HPP_
+
+#include <semaphore.h>
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#define XAPP_CACHE_LINE 64
+
+static inline size_t xapp_queue_capacity(size_t capacity) {
+	size_t size = 2;
+	while (size < capacity) {
+		size <<= 1;
+	}
+	return size;
+}
+
+// Waits for a post on sem, spinning instead of sleeping in the kernel when busy polling
+static inline void xapp_sem_wait(sem_t *sem, bool spin) {
+	if (spin) {
+		while (sem_trywait(sem) != 0) {
+			;
+		}
+	} else {
+		while (sem_wait(sem) != 0) {
+			;	// EINTR
+		}
+	}
+}
+
+/*
+	Single producer single consumer ring buffer.
+	push() must only be called from one thread and pop() from another one.
+	Capacity is rounded up to the next power of two.
+*/
+template <typename T>
+class SpscQueue {
+public:
+	explicit SpscQueue(size_t capacity):
+		_mask(xapp_queue_capacity(capacity) - 1),
+		_slots(new T[_mask + 1]),
+		_head(0),
+		_tail(0) {};
+
+	SpscQueue(SpscQueue const &) = delete;
+	SpscQueue& operator=(SpscQueue const &) = delete;
+
+	bool push(const T &item) {
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail - _head_cache > _mask) {
+			_head_cache = _head.load(std::memory_order_acquire);
+			if (tail - _head_cache > _mask) {
+				return false;	// full
+			}
+		}
+		_slots[tail & _mask] = item;
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(T &item) {
+		size_t head = _head.load(std::memory_order_relaxed);
+		if (head == _tail_cache) {
+			_tail_cache = _tail.load(std::memory_order_acquire);
+			if (head == _tail_cache) {
+				return false;	// empty
+			}
+		}
+		item = _slots[head & _mask];
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// approximate when called concurrently with push/pop
+	size_t size() const {
+		return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+	}
+
+	size_t capacity() const { return _mask + 1; }
+
+private:
+	const size_t _mask;
+	std::unique_ptr<T[]> _slots;
+
+	// consumer side
+	char _pad0[XAPP_CACHE_LINE];
+	std::atomic<size_t> _head;
+	size_t _tail_cache = 0;
+
+	// producer side
+	char _pad1[XAPP_CACHE_LINE];
+	std::atomic<size_t> _tail;
+	size_t _head_cache = 0;
+	char _pad2[XAPP_CACHE_LINE];
+};
+
+/*
+	Multiple producer multiple consumer ring buffer (D. Vyukov's bounded queue).
+	Each slot carries a sequence number telling whether it is ready to be written or read,
+	so producers and consumers only contend on their own position counter.
+	Capacity is rounded up to the next power of two.
+*/
+template <typename T>
+class MpmcQueue {
+public:
+	explicit MpmcQueue(size_t capacity):
+		_mask(xapp_queue_capacity(capacity) - 1),
+		_cells(new Cell[_mask + 1]),
+		_enqueue_pos(0),
+		_dequeue_pos(0) {
+		for (size_t i = 0; i <= _mask; i++) {
+			_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	};
+
+	MpmcQueue(MpmcQueue const &) = delete;
+	MpmcQueue& operator=(MpmcQueue const &) = delete;
+
+	bool push(const T &item) {
+		Cell *cell;
+		size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &_cells[pos & _mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+			if (diff == 0) {
+				if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;	// full
+			} else {
+				pos = _enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		cell->data = item;
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/*
+		Returns false when empty, but also when the next slot has been claimed by a producer
+		that has not finished writing to it yet, so callers expecting an item have to retry.
+	*/
+	bool pop(T &item) {
+		Cell *cell;
+		size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+		while (true) {
+			cell = &_cells[pos & _mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+			if (diff == 0) {
+				if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;	// empty
+			} else {
+				pos = _dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+		item = cell->data;
+		cell->sequence.store(pos + _mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	// approximate when called concurrently with push/pop
+	size_t size() const {
+		size_t tail = _enqueue_pos.load(std::memory_order_acquire);
+		size_t head = _dequeue_pos.load(std::memory_order_acquire);
+		return tail > head ? tail - head : 0;
+	}
+
+	size_t capacity() const { return _mask + 1; }
+
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		T data;
+	};
+
+	const size_t _mask;
+	std::unique_ptr<Cell[]> _cells;
+
+	char _pad0[XAPP_CACHE_LINE];
+	std::atomic<size_t> _enqueue_pos;
+	char _pad1[XAPP_CACHE_LINE];
+	std::atomic<size_t> _dequeue_pos;
+	char _pad2[XAPP_CACHE_LINE];
+};
+
+#endif /* XAPP_UTILS_XAPP_QUEUE_HPP_ */
@@ -19,27 +19,71 @@
 
 
 #include "xapp_rmr.hpp"
+#include "xapp_control_plane.hpp"
 #include <stdlib.h>
-#define  RMR_MAX_XID 32
+#include <sys/eventfd.h>
+
+// Send buffers are kept per thread, so that steady state sending neither allocates nor locks.
+// A cache only frees its buffers while their rmr context is open: threads may exit after the
+// XappRmr has been destroyed, and the buffers of a closed context are then simply dropped.
+static std::mutex send_context_lock;
+static void *send_context = NULL;	// open context, guarded by send_context_lock
+
+struct send_buffer_cache {
+	~send_buffer_cache() {
+		std::lock_guard<std::mutex> guard(send_context_lock);
+		release();
+	}
+
+	// send_context_lock must be held
+	void release() {
+		if (ctx != NULL && ctx == send_context) {
+			for (auto mbuf : buffers) {
+				rmr_free_msg(mbuf);
+			}
+		}
+		buffers.clear();
+	}
+
+	void *ctx = NULL;	// context the buffers were allocated from
+	std::vector<rmr_mbuf_t *> buffers;
+};
+
+static thread_local send_buffer_cache send_buffers;
 
-XappRmr::XappRmr(std::string port, int rmrattempts){
+XappRmr::XappRmr(std::string port, int msg_size, int rmrattempts){
 
 	_proto_port = port;
+	_msg_size = msg_size;
 	_nattempts = rmrattempts;
 	_xapp_rmr_ctx = NULL;
-	_xapp_send_buff =NULL;
 	_rmr_is_ready = false;
 	_listen = false;
+	_rcv_fd = -1;
+	_epoll_fd = -1;
+	_wakeup_fd = -1;
+	_busy_poll = false;
+	_control_plane = NULL;
+	_retry_queue_size = SEND_QUEUE_SIZE;
+	_retry_drop_policy = DROP_OLDEST;
 
 };
 
 XappRmr::~XappRmr(void){
 	// free memory
-
-	if(_xapp_send_buff)
-		rmr_free_msg(_xapp_send_buff);
-
+	_sender.reset();	// pending retries need the rmr context
+	if (_epoll_fd >= 0){
+		close(_epoll_fd);
+	}
+	if (_wakeup_fd >= 0){
+		close(_wakeup_fd);
+	}
 	if (_xapp_rmr_ctx){
+		std::lock_guard<std::mutex> guard(send_context_lock);
+		send_buffers.release();	// the other threads have released theirs when they stopped
+		if (send_context == _xapp_rmr_ctx) {
+			send_context = NULL;
+		}
 		rmr_close(_xapp_rmr_ctx);
 	}
 };
@@ -61,92 +105,245 @@ void XappRmr::xapp_rmr_init(bool rmr_listen){
 	_rmr_is_ready = true;
 	mdclog_write(MDCLOG_INFO,"RMR Context is Ready, file= %s, line=%d",__FILE__,__LINE__);
 
+	{
+		std::lock_guard<std::mutex> guard(send_context_lock);
+		send_context = _xapp_rmr_ctx;
+	}
+	_sender = std::make_unique<XappSender>(_xapp_rmr_ctx, _nattempts, _retry_queue_size, _retry_drop_policy);
+
+	if(!xapp_rmr_epoll_init()){
+		mdclog_write(MDCLOG_WARN,"RMR receive fd not available, receivers will poll for messages, file= %s, line=%d",__FILE__,__LINE__);
+	}
+
 	//Set the listener requirement
 	_listen = rmr_listen;
 	return;
 
 }
 
-bool XappRmr::rmr_header(xapp_rmr_header *hdr){
+// Receivers block on the rmr receive fd and on an eventfd that is signalled to stop them
+bool XappRmr::xapp_rmr_epoll_init(void){
+	struct epoll_event event;
 
-	_xapp_send_buff->mtype  = hdr->message_type;
-	_xapp_send_buff->len = hdr->payload_length;
-	_xapp_send_buff->sub_id = -1;
-	rmr_str2meid(_xapp_send_buff, hdr->meid);
-	rmr_str2xact(_xapp_send_buff, hdr->meid);
+	int rcv_fd = rmr_get_rcvfd(_xapp_rmr_ctx);
+	if(rcv_fd < 0){
+		return false;
+	}
 
-	mdclog_write(MDCLOG_INFO,"hdr->meid = %s",hdr->meid);
+	_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	_wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(_epoll_fd < 0 || _wakeup_fd < 0){
+		mdclog_write(MDCLOG_ERR,"Unable to create epoll fds: %s, file= %s, line=%d",strerror(errno),__FILE__,__LINE__);
+		return false;
+	}
+
+	// one-shot, so that a message wakes up only one receiver, which re-arms the fd once it has received it
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN | EPOLLONESHOT;
+	event.data.fd = rcv_fd;
+	if(epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, rcv_fd, &event) != 0){
+		mdclog_write(MDCLOG_ERR,"Unable to add rmr fd to epoll: %s, file= %s, line=%d",strerror(errno),__FILE__,__LINE__);
+		return false;
+	}
 
+	// level-triggered and never drained while stopped, so that all receivers wake up
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = _wakeup_fd;
+	if(epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _wakeup_fd, &event) != 0){
+		mdclog_write(MDCLOG_ERR,"Unable to add wakeup fd to epoll: %s, file= %s, line=%d",strerror(errno),__FILE__,__LINE__);
+		return false;
+	}
+
+	_rcv_fd = rcv_fd;
 	return true;
 }
 
-//RMR Send with payload and header.
-bool XappRmr::xapp_rmr_send(xapp_rmr_header *hdr, void *payload){
+/*
+	Blocks until a message arrives or receivers are told to stop, and has the same semantics as rmr_torcv_msg.
+	Returns mbuf with state RMR_ERR_TIMEOUT (or NULL) when woken up without a message.
+*/
+rmr_mbuf_t* XappRmr::xapp_rmr_rcv(rmr_mbuf_t *mbuf){
+	struct epoll_event events[2];
+
+	if(_busy_poll){
+		do {
+			mbuf = rmr_torcv_msg(_xapp_rmr_ctx, mbuf, 0);
+		} while(mbuf != NULL && mbuf->state == RMR_ERR_TIMEOUT && _listen);
+		return mbuf;
+	}
+
+	if(_rcv_fd < 0){
+		return rmr_torcv_msg(_xapp_rmr_ctx, mbuf, 2000);	// come up every 2 sec to check for get_listen()
+	}
+
+	bool stop = false;
+	bool readable = false;
+	int nevents = epoll_wait(_epoll_fd, events, 2, -1);	// fails on EINTR, treated as a timeout
+	for(int i = 0; i < nevents; i++){
+		if(events[i].data.fd == _wakeup_fd){
+			stop = true;
+		} else if(events[i].data.fd == _rcv_fd){
+			readable = true;
+		}
+	}
+
+	if(readable && !stop){
+		mbuf = rmr_torcv_msg(_xapp_rmr_ctx, mbuf, 0);	// a message is queued, so this does not block
+	} else if(mbuf != NULL){
+		mbuf->state = RMR_ERR_TIMEOUT;
+	}
+
+	if(readable){	// re-arm the receive fd for the next receiver
+		struct epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN | EPOLLONESHOT;
+		event.data.fd = _rcv_fd;
+		epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, _rcv_fd, &event);
+	}
+
+	return mbuf;
+}
+
+bool XappRmr::rmr_header(rmr_mbuf_t *send_buff, xapp_rmr_header *hdr){
 
-	// Get the thread id
-	std::thread::id my_id = std::this_thread::get_id();
-	std::stringstream thread_id;
-	std::stringstream ss;
+	send_buff->mtype  = hdr->message_type;
+	send_buff->len = hdr->payload_length;
+	send_buff->sub_id = -1;
+	rmr_str2meid(send_buff, hdr->meid);
+	rmr_str2xact(send_buff, hdr->meid);
 
-	thread_id << my_id;
-	mdclog_write(MDCLOG_INFO, "Sending thread %s",  thread_id.str().c_str());
+	mdclog_write(MDCLOG_INFO,"hdr->meid = %s",hdr->meid);
+
+	return true;
+}
 
+// Transaction ids are <thread number>-<per thread sequence>, unique within the process without any shared counter
+static std::atomic<unsigned int> send_threads(0);
+static thread_local unsigned int send_thread_num = send_threads++;
+static thread_local unsigned long send_xact_seq = 0;
 
-	int rmr_attempts = _nattempts;
+rmr_mbuf_t* XappRmr::get_send_buffer(int payload_length){
+	rmr_mbuf_t *mbuf;
 
-	if( _xapp_send_buff == NULL ) {
-		_xapp_send_buff = rmr_alloc_msg(_xapp_rmr_ctx, RMR_DEF_SIZE);
+	if(send_buffers.ctx != _xapp_rmr_ctx) {
+		send_buffers.buffers.clear();	// left from a context that has been closed
+		send_buffers.ctx = _xapp_rmr_ctx;
 	}
 
-	bool res = rmr_header(hdr);
-	if(!res){
-		mdclog_write(MDCLOG_ERR,"RMR HEADERS were incorrectly populated, file= %s, line=%d",__FILE__,__LINE__);
-		return false;
+	if(!send_buffers.buffers.empty()) {
+		mbuf = send_buffers.buffers.back();
+		send_buffers.buffers.pop_back();
+	} else {
+		mbuf = rmr_alloc_msg(_xapp_rmr_ctx, _msg_size);
+		if(mbuf == NULL) {
+			return NULL;
+		}
 	}
 
-	mdclog_write(MDCLOG_INFO,"------ start of Xid updated, file= %s, line=%d",__FILE__,__LINE__);
-	int test_support_xact_count = rand();
-        char *xid = (char *) malloc( sizeof( char ) * RMR_MAX_SRC );
-        memset(xid, '\0',RMR_MAX_SRC);
-	snprintf(xid, RMR_MAX_XID, "%010d", test_support_xact_count );
+	if(rmr_payload_size(mbuf) < payload_length) {
+		rmr_mbuf_t *larger = rmr_realloc_payload(mbuf, payload_length, 0, 0);
+		if(larger == NULL) {
+			rmr_free_msg(mbuf);
+			return NULL;
+		}
+		mbuf = larger;
+	}
 
-	mdclog_write(MDCLOG_INFO,"before xapp_send_buff Xid=%s, file= %s, line=%d",xid,__FILE__,__LINE__);
-        memcpy(_xapp_send_buff->xaction, xid, RMR_MAX_XID);
+	return mbuf;
+}
 
-	mdclog_write(MDCLOG_INFO,"Xid=%s, file= %s, line=%d",_xapp_send_buff->xaction,__FILE__,__LINE__);
+void XappRmr::put_send_buffer(rmr_mbuf_t *mbuf){
+	if(send_buffers.ctx == _xapp_rmr_ctx && send_buffers.buffers.size() < SEND_BUFFER_CACHE_SIZE) {
+		if(send_buffers.buffers.capacity() == 0) {
+			send_buffers.buffers.reserve(SEND_BUFFER_CACHE_SIZE);
+		}
+		send_buffers.buffers.push_back(mbuf);
+	} else {
+		rmr_free_msg(mbuf);
+	}
+}
+
+//RMR Send with payload and header.
+//Returns true once sent, or queued to be retried in the background when rmr could not send it right away.
+bool XappRmr::xapp_rmr_send(xapp_rmr_header *hdr, void *payload){
 
-	memcpy(_xapp_send_buff->payload, payload, hdr->payload_length);
-	_xapp_send_buff->len = hdr->payload_length;
+	mdclog_write(MDCLOG_INFO, "Sending thread %u", send_thread_num);
 
 	if(!_rmr_is_ready) {
 		mdclog_write(MDCLOG_ERR,"RMR Context is Not Ready in SENDER, file= %s, line=%d",__FILE__,__LINE__);
 		return false;
 	}
 
-	while(rmr_attempts > 0){
+	// each caller (thread) gets its own send buffer, so senders never share an mbuf
+	rmr_mbuf_t *send_buff = get_send_buffer(hdr->payload_length);
+	if(send_buff == NULL) {
+		mdclog_write(MDCLOG_ERR,"Unable to allocate RMR send buffer, file= %s, line=%d",__FILE__,__LINE__);
+		return false;
+	}
 
-		_xapp_send_buff = rmr_send_msg(_xapp_rmr_ctx,_xapp_send_buff);
-		if(!_xapp_send_buff) {
-			mdclog_write(MDCLOG_ERR,"Error In Sending Message , file= %s, line=%d, attempt=%d",__FILE__,__LINE__,rmr_attempts);
-			rmr_attempts--;
-		}
-		else if (_xapp_send_buff->state == RMR_OK){
-			mdclog_write(MDCLOG_INFO,"Message Sent: RMR State = RMR_OK");
-        	mdclog_write(MDCLOG_INFO,"_xapp_send_buff->xaction: %s",_xapp_send_buff->xaction);
-			rmr_attempts = 0;
-			_xapp_send_buff = NULL;
-			return true;
-		}
-		else
-		{
-			mdclog_write(MDCLOG_INFO,"Need to retry RMR: state=%d, attempt=%d, file=%s, line=%d",_xapp_send_buff->state, rmr_attempts,__FILE__,__LINE__);
-			if(_xapp_send_buff->state == RMR_ERR_RETRY){
-				usleep(1);			}
-				rmr_attempts--;
-		}
-		sleep(1);
+	bool res = rmr_header(send_buff, hdr);
+	if(!res){
+		mdclog_write(MDCLOG_ERR,"RMR HEADERS were incorrectly populated, file= %s, line=%d",__FILE__,__LINE__);
+		rmr_free_msg(send_buff);
+		return false;
+	}
+
+	snprintf((char *) send_buff->xaction, RMR_MAX_XID, "%u-%010lu", send_thread_num, ++send_xact_seq);
+	mdclog_write(MDCLOG_INFO,"Xid=%s, file= %s, line=%d",send_buff->xaction,__FILE__,__LINE__);
+
+	memcpy(send_buff->payload, payload, hdr->payload_length);
+	send_buff->len = hdr->payload_length;
+
+	send_buff = rmr_send_msg(_xapp_rmr_ctx, send_buff);
+	if(!send_buff) {
+		mdclog_write(MDCLOG_ERR,"Error In Sending Message , file= %s, line=%d",__FILE__,__LINE__);
+		metrics_count(METRIC_SEND_FAILURES);
+		return false;	// rmr has not given the buffer back, so there is nothing left to resend
+	}
+	else if (send_buff->state == RMR_OK){
+		mdclog_write(MDCLOG_INFO,"Message Sent: RMR State = RMR_OK");
+		metrics_sent(send_buff->mtype);
+		put_send_buffer(send_buff);	// rmr hands back an empty buffer for the next send
+		return true;
 	}
-	return false;
+
+	mdclog_write(MDCLOG_INFO,"Need to retry RMR: state=%d, file=%s, line=%d",send_buff->state,__FILE__,__LINE__);
+	metrics_count(METRIC_SEND_FAILURES);
+	if(_nattempts <= 1) {
+		put_send_buffer(send_buff);
+		return false;
+	}
+	return _sender->enqueue(send_buff, false);	// owns the buffer from now on
+}
+
+// Returns the message to its sender, a failed message is handed to the retry queue and NULL is returned
+rmr_mbuf_t* XappRmr::xapp_rmr_rts(rmr_mbuf_t *mbuf){
+	int mtype = mbuf->mtype;
+	mbuf = rmr_rts_msg(_xapp_rmr_ctx, mbuf);
+	if(mbuf != NULL && mbuf->state == RMR_OK) {
+		metrics_sent(mtype);
+	} else {
+		metrics_count(METRIC_SEND_FAILURES);
+	}
+	if(mbuf != NULL && mbuf->state != RMR_OK && _sender && _nattempts > 1) {
+		mdclog_write(MDCLOG_INFO,"Need to retry RMR return to sender: state=%d, file=%s, line=%d",mbuf->state,__FILE__,__LINE__);
+		_sender->enqueue(mbuf, true);
+		return NULL;
+	}
+	return mbuf;
+}
+
+size_t XappRmr::get_retry_pending(void){
+	return _sender ? _sender->get_pending() : 0;
+}
+
+unsigned long XappRmr::get_retries(void){
+	return _sender ? _sender->get_retries() : 0;
+}
+
+unsigned long XappRmr::get_dropped(void){
+	return _sender ? _sender->get_dropped() : 0;
 }
 
 //----------------------------------------
@@ -159,6 +356,40 @@ bool XappRmr::get_listen(void){
 
 void XappRmr::set_listen(bool listen){
   _listen = listen;
+
+  if(_wakeup_fd >= 0){
+    uint64_t value = 1;
+    if(listen){
+      while(read(_wakeup_fd, &value, sizeof(value)) > 0);	// drain a previous stop
+    } else if(write(_wakeup_fd, &value, sizeof(value)) != sizeof(value)){
+      mdclog_write(MDCLOG_ERR,"Unable to wake up receivers: %s, file= %s, line=%d",strerror(errno),__FILE__,__LINE__);
+    }
+  }
+}
+
+// Must be set before xapp_rmr_init()
+void XappRmr::set_retry_queue(size_t size, drop_policy_t policy){
+  _retry_queue_size = size;
+  _retry_drop_policy = policy;
+}
+
+// Must be set before receivers are started
+void XappRmr::set_busy_poll(bool busy_poll){
+  _busy_poll = busy_poll;
+}
+
+bool XappRmr::get_busy_poll(void){
+  return _busy_poll;
+}
+
+// Must be set before receivers are started
+void XappRmr::set_control_plane(XappControlPlane *control_plane){
+  _control_plane = control_plane;
+}
+
+// True when the message has been handed to the control-plane thread
+bool XappRmr::offer_control_plane(rmr_mbuf_t *mbuf){
+  return _control_plane != NULL && _control_plane->offer(mbuf);
 }
 
 int XappRmr::get_is_ready(void){
@@ -30,7 +30,6 @@
 #endif
 
 #include <iostream>
-#include <fstream>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
@@ -41,6 +40,8 @@
 #include <functional>
 #include <map>
 #include <mutex>
+#include <atomic>
+#include <climits>
 #include <sys/epoll.h>
 #include <rmr/rmr.h>
 #include <rmr/RIC_message_types.h>
@@ -61,6 +62,13 @@
 #include "subscription_response.hpp"
 #include "e2sm_subscription.hpp"
 #include "subs_mgmt.hpp"
+#include "xapp_sender.hpp"
+#include "xapp_latency.hpp"
+#include "xapp_metrics.hpp"
+
+#define SEND_BUFFER_CACHE_SIZE 8	// send buffers kept per thread
+
+class XappControlPlane;
 
 typedef struct{
 	struct timespec ts;
@@ -79,15 +87,27 @@ class XappRmr{
 private:
 	std::string _proto_port;
 	int _nattempts;
+	int _msg_size;		// payload size of send buffers
 	bool _rmr_is_ready;
-    bool _listen;
+	std::atomic<bool> _listen;	// read by all receiver threads
 	void* _xapp_rmr_ctx;
-	rmr_mbuf_t*		_xapp_send_buff;	// send buffer // FIXME Huff: move this line to the function to allow multi-threading
+	int _rcv_fd;		// rmr receive fd, -1 when rmr does not expose one and receivers have to poll
+	int _epoll_fd;		// watches the rmr receive fd and the wakeup fd
+	int _wakeup_fd;		// eventfd signalled when receivers must stop
+	bool _busy_poll;	// receivers spin on non-blocking receives instead of waiting in epoll
+	size_t _retry_queue_size;
+	drop_policy_t _retry_drop_policy;
+	std::unique_ptr<XappSender> _sender;	// retries failed sends off the calling thread
+	XappControlPlane *_control_plane;	// takes control-plane messages off the receivers, if any
+
+	bool xapp_rmr_epoll_init(void);
+	rmr_mbuf_t* get_send_buffer(int);
+	void put_send_buffer(rmr_mbuf_t*);
 
 
 public:
 
-	XappRmr(std::string, int rmrattempts=10);
+	XappRmr(std::string, int msg_size, int rmrattempts=10);
 	~XappRmr(void);
 	void xapp_rmr_init(bool);
 
@@ -95,9 +115,22 @@ public:
 	void xapp_rmr_receive(MessageProcessor&&, XappRmr *parent);
 
 	bool xapp_rmr_send(xapp_rmr_header*, void*);
+	rmr_mbuf_t* xapp_rmr_rts(rmr_mbuf_t*);
+	void set_retry_queue(size_t, drop_policy_t);
+
+	// retry queue statistics, zero until xapp_rmr_init()
+	size_t get_retry_pending(void);
+	unsigned long get_retries(void);
+	unsigned long get_dropped(void);
+
+	rmr_mbuf_t* xapp_rmr_rcv(rmr_mbuf_t*);
 
-	bool rmr_header(xapp_rmr_header*);
+	bool rmr_header(rmr_mbuf_t*, xapp_rmr_header*);
 	void set_listen(bool);
+	void set_busy_poll(bool);
+	bool get_busy_poll(void);
+	void set_control_plane(XappControlPlane *);
+	bool offer_control_plane(rmr_mbuf_t *);
 	bool get_listen(void);
 	int get_is_ready(void);
 	bool get_isRunning(void);
@@ -105,20 +138,36 @@ public:
 
 };
 
-static inline long elapsed_microseconds(struct timespec ts_start, struct timespec ts_end) {
-    unsigned long start;
-    unsigned long end;
-    long latency;
+#define TURNAROUND_REPORT_INTERVAL 10000
 
-    start = ts_start.tv_sec * 1000000000 + ts_start.tv_nsec;
-    end = ts_end.tv_sec * 1000000000 + ts_end.tv_nsec;
+// Turnaround (receive to return to sender) of the messages answered by a receiver thread
+struct turnaround_stats {
+	turnaround_stats(): count(0), sum(0), min(LONG_MAX), max(0) {};
 
-    latency = (end - start) / 1000000;     // converting to microseconds
+	void add(struct timespec &ts_start, struct timespec &ts_end) {
+		long us = (ts_end.tv_sec - ts_start.tv_sec) * 1000000 + (ts_end.tv_nsec - ts_start.tv_nsec) / 1000;
+		count++;
+		sum += us;
+		if (us < min) min = us;
+		if (us > max) max = us;
+	}
 
-    return latency;
-}
+	std::string to_string(const char *mode) const {
+		std::stringstream ss;
+		ss << "Turnaround in " << mode << " mode: count=" << count << " min=" << (count ? min : 0)
+				<< " avg=" << (count ? sum / (long) count : 0) << " max=" << max << " us";
+		return ss.str();
+	}
+
+	unsigned long count;
+	long sum;
+	long min;
+	long max;
+};
 
 // main workhorse thread which does the listen->process->respond loop
+// Several workers can run this loop at the same time on the shared rmr context (rmr context is thread safe),
+// so each worker must be given its own copy of the message handler and it owns its receive buffer.
 template <class MsgHandler>
 void XappRmr::xapp_rmr_receive(MsgHandler&& msgproc, XappRmr *parent){
 	rmr_mbuf_t *mbuf = NULL;
@@ -128,7 +177,6 @@ void XappRmr::xapp_rmr_receive(MsgHandler&& msgproc, XappRmr *parent){
 	std::thread::id my_id = std::this_thread::get_id();
 	std::stringstream thread_id;
 	std::stringstream ss;
-	std::fstream io_file;
 
 	thread_id << my_id;
 
@@ -141,39 +189,43 @@ void XappRmr::xapp_rmr_receive(MsgHandler&& msgproc, XappRmr *parent){
 	assert(rmr_context != NULL);
 
 	mdclog_write(MDCLOG_INFO, "Starting receiver thread %s",  thread_id.str().c_str());
-	io_file.open("/tmp/timestamp.txt", std::ios::in|std::ios::out|std::ios::app);
 
-	struct timespec ts_recv;
-	struct timespec ts_sent;
+	struct timespec ts_start;
+	struct timespec ts_end;
+	turnaround_stats turnaround;
+	const char *mode = parent->get_busy_poll() ? "busy-poll" : "blocking";
 	int num = 0;
+	latency_stamps stamps;
 
 	while(parent->get_listen()) {
 		mdclog_write(MDCLOG_DEBUG, "Listening at Thread: %s",  thread_id.str().c_str());
 
-		mbuf = rmr_torcv_msg( rmr_context, mbuf, 2000 ); // come up every 2 sec to check for get_listen()
+		mbuf = parent->xapp_rmr_rcv(mbuf);	// also returns when set_listen(false) is called
 
 		if (mbuf == NULL || mbuf->state == RMR_ERR_TIMEOUT) {
 			continue;
 		}
-
-		if (io_file) {
-			if (mdclog_level_get() > MDCLOG_INFO) {
-				clock_gettime(CLOCK_REALTIME, &ts_recv);
-				io_file << "Received Msg with msgType: " << mbuf->mtype << " at time: " <<  (ts_recv.tv_sec * 1000) + (ts_recv.tv_nsec/1000000) << std::endl;
-			}
-		}
+		clock_gettime(CLOCK_MONOTONIC, &ts_start);
+		stamps.clear();
+		stamps.received = (uint64_t) ts_start.tv_sec * 1000000000ULL + (uint64_t) ts_start.tv_nsec;
 
 		if( mbuf->mtype < 0 || mbuf->state != RMR_OK ) {
 			mdclog_write(MDCLOG_ERR, "bad msg:  state=%d  errno=%d, file= %s, line=%d", mbuf->state, errno, __FILE__,__LINE__ );
-			return;
+			continue;	// the buffer is reused by the next receive
 		}
 		else
 		{
 			mdclog_write(MDCLOG_INFO,"RMR Received Message of Type: %d",mbuf->mtype);
 			mdclog_write(MDCLOG_DEBUG,"RMR Received Message: %s",(char*)mbuf->payload);
+			metrics_received(mbuf->mtype);
+
+			if (parent->offer_control_plane(mbuf)) {
+				mbuf = NULL;	// now owned by the control plane, rmr allocates a new buffer on the next receive
+				continue;
+			}
 
 		    //in case message handler returns true, need to resend the message.
-			msgproc(mbuf, resend);
+			msgproc(mbuf, resend, &stamps);
 
 			//start of code to check decoding indication payload
 
@@ -184,19 +236,15 @@ void XappRmr::xapp_rmr_receive(MsgHandler&& msgproc, XappRmr *parent){
 				mdclog_write(MDCLOG_INFO,"RMR Return to Sender Message of Type: %d",mbuf->mtype);
 				mdclog_write(MDCLOG_DEBUG,"RMR Return to Sender Message: %s",(char*)mbuf->payload);
 
-				if (io_file) {
-					if (mdclog_level_get() > MDCLOG_INFO) {
-						clock_gettime(CLOCK_REALTIME, &ts_sent);
-						io_file << "Send Msg with msgType: " << mbuf->mtype << " at time: " << (ts_sent.tv_sec * 1000) + (ts_sent.tv_nsec/1000000) << std::endl;
+				mbuf = parent->xapp_rmr_rts(mbuf);	// NULL when queued for retry, rmr allocates a new buffer on the next receive
+				stamps.record_sent();
 
-						// io_file << "Time diff: " << ((ts_sent.tv_sec - ts_recv.tv_sec)*1000 + (ts_sent.tv_usec - ts_recv.tv_usec)/1000) << std::endl;
-						io_file << "Time diff: " << elapsed_microseconds(ts_recv, ts_sent) << std::endl;
-					}
+				clock_gettime(CLOCK_MONOTONIC, &ts_end);
+				turnaround.add(ts_start, ts_end);
+				if (turnaround.count % TURNAROUND_REPORT_INTERVAL == 0) {
+					mdclog_write(MDCLOG_INFO, "Thread %s: %s", thread_id.str().c_str(), turnaround.to_string(mode).c_str());
 				}
 
-				rmr_rts_msg(rmr_context, mbuf );
-				//sleep(1);
-
 				*resend = false;
 			}
 
@@ -204,9 +252,7 @@ void XappRmr::xapp_rmr_receive(MsgHandler&& msgproc, XappRmr *parent){
 
 	}
 
-	if (io_file) {
-		io_file.close();
-	}
+	mdclog_write(MDCLOG_INFO, "Thread %s: %s", thread_id.str().c_str(), turnaround.to_string(mode).c_str());
 
 	// Clean up
 	try{
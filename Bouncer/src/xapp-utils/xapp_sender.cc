@@ -0,0 +1,220 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+#include "xapp_sender.hpp"
+
+XappSender::XappSender(void *rmr_ctx, int max_attempts, size_t capacity, drop_policy_t policy){
+	_rmr_ctx = rmr_ctx;
+	_max_attempts = max_attempts;
+	_policy = policy;
+	_current = 0;
+	_next_seq = 0;
+	_retries = 0;
+	_dropped = 0;
+
+	if(capacity < 1) {
+		capacity = 1;
+	}
+	_entries.resize(capacity);
+	_free.reserve(capacity);
+	for(size_t i = capacity; i > 0; i--) {
+		_entries[i - 1].mbuf = NULL;
+		_free.push_back(i - 1);
+	}
+	_wheel.resize(SEND_WHEEL_SLOTS);
+
+	_running = true;
+	_thread = std::thread(&XappSender::run, this);
+}
+
+XappSender::~XappSender(void){
+	{
+		std::lock_guard<std::mutex> guard(_mutex);
+		_running = false;
+	}
+	_cond.notify_one();
+	if(_thread.joinable()) {
+		_thread.join();
+	}
+
+	for(auto &e : _entries) {
+		if(e.mbuf != NULL) {
+			drop(e, "shutting down");
+		}
+	}
+}
+
+/*
+	Takes ownership of a message that has already been tried once and failed.
+	Returns false when the message was dropped right away.
+*/
+bool XappSender::enqueue(rmr_mbuf_t *mbuf, bool rts){
+	entry e;
+	e.mbuf = mbuf;
+	e.attempts = 1;
+	e.rts = rts;
+
+	std::lock_guard<std::mutex> guard(_mutex);
+	e.seq = _next_seq++;
+	bool was_idle = _free.size() == _entries.size();
+
+	if(!insert(e)) {
+		return false;
+	}
+	if(was_idle) {
+		_cond.notify_one();	// the retry thread does not tick while nothing is pending
+	}
+	return true;
+}
+
+size_t XappSender::get_pending(void){
+	std::lock_guard<std::mutex> guard(_mutex);
+	return _entries.size() - _free.size();
+}
+
+unsigned long XappSender::get_retries(void){
+	std::lock_guard<std::mutex> guard(_mutex);
+	return _retries;
+}
+
+unsigned long XappSender::get_dropped(void){
+	std::lock_guard<std::mutex> guard(_mutex);
+	return _dropped;
+}
+
+// Must be called with _mutex held
+bool XappSender::insert(entry &e){
+	uint32_t index;
+
+	if(_free.empty()) {
+		if(_policy == DROP_NEWEST) {
+			drop(e, "retry queue is full");
+			return false;
+		}
+
+		index = 0;	// the queue is full, so all entries are in use
+		for(uint32_t i = 1; i < _entries.size(); i++) {
+			if(_entries[i].seq < _entries[index].seq) {
+				index = i;
+			}
+		}
+		if(e.seq < _entries[index].seq) {
+			drop(e, "retry queue is full");	// a retried message older than anything queued
+			return false;
+		}
+		drop(_entries[index], "retry queue is full, dropping oldest message");	// its timer becomes stale
+
+	} else {
+		index = _free.back();
+		_free.pop_back();
+	}
+
+	_entries[index] = e;
+
+	size_t backoff = (size_t) 1 << (e.attempts - 1);
+	if(backoff > SEND_MAX_BACKOFF || e.attempts > 16) {
+		backoff = SEND_MAX_BACKOFF;
+	}
+	_wheel[(_current + backoff) % SEND_WHEEL_SLOTS].push_back({index, e.seq});
+
+	return true;
+}
+
+// Must be called with _mutex held, or from the destructor
+void XappSender::drop(entry &e, const char *reason){
+	mdclog_write(MDCLOG_WARN, "Dropping rmr message of type %d after %d attempts: %s", e.mbuf->mtype, e.attempts, reason);
+	rmr_free_msg(e.mbuf);
+	e.mbuf = NULL;
+	_dropped++;
+}
+
+void XappSender::run(void){
+	std::vector<entry> due;
+	const std::chrono::milliseconds tick(SEND_TICK_MS);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_last_tick = std::chrono::steady_clock::now();
+
+	while(_running) {
+		if(_free.size() == _entries.size()) {
+			_cond.wait(lock);	// nothing to retry
+			_last_tick = std::chrono::steady_clock::now();
+			continue;
+		}
+
+		_cond.wait_for(lock, tick);
+
+		auto now = std::chrono::steady_clock::now();
+		size_t ticks = (now - _last_tick) / tick;
+		if(ticks == 0) {
+			continue;
+		}
+		_last_tick += ticks * tick;
+		if(ticks > SEND_WHEEL_SLOTS) {
+			ticks = SEND_WHEEL_SLOTS;
+		}
+
+		due.clear();
+		for(size_t i = 0; i < ticks; i++) {
+			_current = (_current + 1) % SEND_WHEEL_SLOTS;
+			for(auto &t : _wheel[_current]) {
+				entry &e = _entries[t.index];
+				if(e.mbuf != NULL && e.seq == t.seq) {
+					due.push_back(e);
+					e.mbuf = NULL;
+					_free.push_back(t.index);
+				}
+			}
+			_wheel[_current].clear();
+		}
+
+		if(due.empty()) {
+			continue;
+		}
+
+		_retries += due.size();
+		lock.unlock();
+
+		for(auto &e : due) {
+			int mtype = e.mbuf->mtype;
+			e.mbuf = e.rts ? rmr_rts_msg(_rmr_ctx, e.mbuf) : rmr_send_msg(_rmr_ctx, e.mbuf);
+			e.attempts++;
+			if(e.mbuf == NULL) {
+				mdclog_write(MDCLOG_ERR, "Error retrying rmr message, rmr did not return the buffer, file= %s, line=%d", __FILE__, __LINE__);
+			} else if(e.mbuf->state == RMR_OK) {
+				metrics_sent(mtype);
+				rmr_free_msg(e.mbuf);
+				e.mbuf = NULL;
+			}
+		}
+
+		lock.lock();
+
+		for(auto &e : due) {
+			if(e.mbuf == NULL) {
+				continue;
+			}
+			if(e.attempts >= _max_attempts) {
+				drop(e, "out of attempts");
+			} else {
+				insert(e);
+			}
+		}
+	}
+}
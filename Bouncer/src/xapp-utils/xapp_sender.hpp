@@ -0,0 +1,104 @@
+/*
+==================================================================================
+
+        Copyright (c) 2019-2020 AT&T Intellectual Property.
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+==================================================================================
+*/
+
+/*
+ * xapp_sender.hpp
+ *
+ * Retries rmr sends asynchronously, so that a congested route never stalls the calling thread.
+ */
+
+#ifndef XAPP_UTILS_XAPP_SENDER_HPP_
+#define XAPP_UTILS_XAPP_SENDER_HPP_
+
+#include <stdint.h>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <rmr/rmr.h>
+#include <mdclog/mdclog.h>
+
+#include "xapp_metrics.hpp"
+
+#define SEND_QUEUE_SIZE		1024	// messages waiting for a retry
+#define SEND_WHEEL_SLOTS	256		// timer wheel span in ticks, must be larger than SEND_MAX_BACKOFF
+#define SEND_TICK_MS		1
+#define SEND_MAX_BACKOFF	128		// ticks
+
+typedef enum {
+	DROP_OLDEST = 0,	// a full queue discards its oldest message to accept a new one
+	DROP_NEWEST			// a full queue rejects new messages
+} drop_policy_t;
+
+/*
+	Messages that could not be sent are parked on a timer wheel and retried by a background thread,
+	backing off exponentially (1, 2, 4, ... ticks) until they are sent or run out of attempts.
+*/
+class XappSender {
+public:
+	XappSender(void *rmr_ctx, int max_attempts, size_t capacity = SEND_QUEUE_SIZE, drop_policy_t policy = DROP_OLDEST);
+	~XappSender(void);
+
+	XappSender(XappSender const &) = delete;
+	XappSender& operator=(XappSender const &) = delete;
+
+	bool enqueue(rmr_mbuf_t *, bool);
+
+	size_t get_pending(void);
+	unsigned long get_retries(void);
+	unsigned long get_dropped(void);
+
+private:
+	struct entry {
+		rmr_mbuf_t *mbuf;	// NULL when the entry is free
+		uint64_t seq;		// age of the message, also tells stale timers apart
+		int attempts;
+		bool rts;			// retried with rmr_rts_msg instead of rmr_send_msg
+	};
+
+	struct timer {
+		uint32_t index;
+		uint64_t seq;
+	};
+
+	bool insert(entry &);
+	void drop(entry &, const char *);
+	void run(void);
+
+	void *_rmr_ctx;
+	int _max_attempts;
+	drop_policy_t _policy;
+
+	std::vector<entry> _entries;
+	std::vector<uint32_t> _free;
+	std::vector<std::vector<timer>> _wheel;
+	size_t _current;
+	std::chrono::steady_clock::time_point _last_tick;
+	uint64_t _next_seq;
+	unsigned long _retries;
+	unsigned long _dropped;
+
+	std::mutex _mutex;
+	std::condition_variable _cond;
+	bool _running;
+	std::thread _thread;
+};
+
+#endif /* XAPP_UTILS_XAPP_SENDER_HPP_ */
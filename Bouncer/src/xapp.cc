@@ -20,6 +20,11 @@
 #include <nlohmann/json.hpp>
 #include <iostream>
 #include <string>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <future>
+#include <unordered_set>
 #include <cpprest/http_client.h>
 #include <cpprest/filestream.h>
 #include <cpprest/uri.h>
@@ -40,6 +45,13 @@ Xapp::Xapp(XappSettings &config, XappRmr &rmr){
 	  config_ref = &config;
 	  xapp_mutex = NULL;
 	  subhandler_ref = NULL;
+	  subscribe_outstanding = 0;
+
+	  std::string endpoints[HTTP_NUM_SERVICES];
+	  endpoints[HTTP_SUBMGR] = config[XappSettings::SettingName::SUBMGR_ENDPOINT];
+	  endpoints[HTTP_APPMGR] = config[XappSettings::SettingName::APPMGR_ENDPOINT];
+	  endpoints[HTTP_E2MGR] = config[XappSettings::SettingName::E2MGR_ENDPOINT];
+	  http_pool = make_unique<XappHttpPool>(endpoints);
 	  return;
   }
 
@@ -63,6 +75,10 @@ void Xapp::stop(void){
 	for(int i=0; i<threadcnt; i++){
 		xapp_rcv_thread[i].detach();
 	}
+	if (control_plane) {
+		control_plane->stop();
+		control_thread.detach();
+	}
 	sleep(10);
 }
 
@@ -90,30 +106,186 @@ void Xapp::start_xapp_receiver(XappMsgHandler& mp_handler, int threads){
 		threads = 1;
 	}
 	rmr_ref->set_listen(true);
+	rmr_ref->set_busy_poll(config_ref->operator[](XappSettings::SettingName::BUSY_POLL).compare("1") == 0);
 	if(xapp_mutex == NULL){
 		xapp_mutex = new std::mutex();
 	}
 
+	start_control_plane(mp_handler);
+
+	std::string mode = config_ref->operator[](XappSettings::SettingName::RECEIVER_MODE);
+	if (mode.compare("pipeline") == 0) {
+		// one receive thread feeds the decode, encode and send stages, each one running on its own threads
+		int decode_threads = 1, encode_threads = 1, send_threads = 1;
+		std::string stages = config_ref->operator[](XappSettings::SettingName::PIPELINE_THREADS);
+		if (sscanf(stages.c_str(), "%d,%d,%d", &decode_threads, &encode_threads, &send_threads) != 3) {
+			mdclog_write(MDCLOG_WARN, "Invalid pipeline threads %s, using one thread per stage", stages.c_str());
+			decode_threads = encode_threads = send_threads = 1;
+		}
+
+		std::lock_guard<std::mutex> guard(*xapp_mutex);
+		pipeline = std::make_unique<XappPipeline>(rmr_ref, decode_threads, encode_threads, send_threads);
+
+		for(int i = 0; i < pipeline->get_threads(PIPELINE_SEND); i++) {
+			std::thread th_send([this]() { pipeline->send_loop(); });
+			xapp_rcv_thread.push_back(std::move(th_send));
+		}
+		for(int i = 0; i < pipeline->get_threads(PIPELINE_ENCODE); i++) {
+			std::thread th_encode([this, mp_handler]() { pipeline->encode_loop(mp_handler); });
+			xapp_rcv_thread.push_back(std::move(th_encode));
+		}
+		for(int i = 0; i < pipeline->get_threads(PIPELINE_DECODE); i++) {
+			std::thread th_decode([this, mp_handler]() { pipeline->decode_loop(mp_handler); });
+			xapp_rcv_thread.push_back(std::move(th_decode));
+		}
+		mdclog_write(MDCLOG_INFO,"Pipeline Receiver Thread, file=%s, line=%d", __FILE__, __LINE__);
+		std::thread th_recv([this]() { pipeline->receive_loop(); });
+		xapp_rcv_thread.push_back(std::move(th_recv));
+		configure_receiver_threads();
+		return;
+	}
+
+	if (threads > 1 && mode.compare("sharded") == 0) {
+		// one thread receives from rmr and dispatches each E2 node to always the same worker
+		std::lock_guard<std::mutex> guard(*xapp_mutex);
+		dispatcher = std::make_unique<XappDispatcher<XappMsgHandler>>(rmr_ref, threads);
+
+		for(int i = 0; i < threads; i++) {
+			mdclog_write(MDCLOG_INFO,"Dispatcher Worker Thread %d, file=%s, line=%d", i, __FILE__, __LINE__);
+			std::thread th_work([this, i, mp_handler]() { dispatcher->worker_loop(i, mp_handler); });
+			xapp_rcv_thread.push_back(std::move(th_work));
+		}
+		std::thread th_recv([this]() { dispatcher->receive_loop(); });
+		xapp_rcv_thread.push_back(std::move(th_recv));
+		configure_receiver_threads();
+		return;
+	}
+
+	if (threads > 1 && mode.compare("shared") != 0) {
+		mdclog_write(MDCLOG_WARN, "Unknown receiver mode %s, using shared receiver mode", mode.c_str());
+	}
+
 	for(int i = 0; i < threads; i++) {
 		mdclog_write(MDCLOG_INFO,"Receiver Thread %d, file=%s, line=%d", i, __FILE__, __LINE__);
 		{
 			std::lock_guard<std::mutex> guard(*xapp_mutex);
-			std::thread th_recv([&](){ rmr_ref->xapp_rmr_receive(std::move(mp_handler), rmr_ref);});
+			// each worker gets its own copy of the handler, so no handler state is shared between threads
+			std::thread th_recv([this, mp_handler]() mutable { rmr_ref->xapp_rmr_receive(std::move(mp_handler), rmr_ref); });
 			xapp_rcv_thread.push_back(std::move(th_recv));
 		}
 	}
+	configure_receiver_threads();
 	return;
 }
 
+// Parses a cpu list such as "2,4-7"
+static std::vector<int> parse_cpu_list(const std::string &list){
+	std::vector<int> cpus;
+	std::stringstream ss(list);
+	std::string item;
+
+	while(std::getline(ss, item, ',')) {
+		int first, last;
+		int n = sscanf(item.c_str(), "%d-%d", &first, &last);
+		if(n == 1) {
+			last = first;
+		} else if(n != 2 || first > last) {
+			mdclog_write(MDCLOG_WARN, "Ignoring invalid cpu range %s", item.c_str());
+			continue;
+		}
+		for(int cpu = first; cpu <= last; cpu++) {
+			cpus.push_back(cpu);
+		}
+	}
+
+	return cpus;
+}
+
+// Subscription responses are handled on a thread of their own, which is not pinned along with the receivers
+void Xapp::start_control_plane(XappMsgHandler &mp_handler){
+	std::lock_guard<std::mutex> guard(*xapp_mutex);
+	if (control_plane) {
+		return;
+	}
+
+	control_plane = std::make_unique<XappControlPlane>(rmr_ref);
+	control_thread = std::thread([this, mp_handler]() { control_plane->control_loop(mp_handler); });
+	rmr_ref->set_control_plane(control_plane.get());
+}
+
+void Xapp::stop_control_plane(){
+	if (!control_plane) {
+		return;
+	}
+
+	rmr_ref->set_control_plane(NULL);	// receivers have been joined already
+	control_plane->stop();
+	if (control_thread.joinable()) {
+		control_thread.join();
+	}
+	control_plane.reset();
+}
+
+// Pins receiver and worker threads round-robin to the configured cpus, and optionally sets SCHED_FIFO
+void Xapp::configure_receiver_threads(){
+	std::vector<int> cpus = parse_cpu_list(config_ref->operator[](XappSettings::SettingName::CPU_AFFINITY));
+	int priority = atoi(config_ref->operator[](XappSettings::SettingName::SCHED_PRIORITY).c_str());
+
+	if(cpus.empty() && priority <= 0) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(*xapp_mutex);
+	for(size_t i = 0; i < xapp_rcv_thread.size(); i++) {
+		pthread_t handle = xapp_rcv_thread[i].native_handle();
+
+		if(!cpus.empty()) {
+			cpu_set_t cpuset;
+			CPU_ZERO(&cpuset);
+			CPU_SET(cpus[i % cpus.size()], &cpuset);
+			int ret = pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpuset);
+			if(ret != 0) {
+				mdclog_write(MDCLOG_WARN, "Unable to pin receiver thread %lu to cpu %d: %s", i, cpus[i % cpus.size()], strerror(ret));
+			}
+		}
+
+		if(priority > 0) {
+			struct sched_param param;
+			memset(&param, 0, sizeof(param));
+			param.sched_priority = priority;
+			int ret = pthread_setschedparam(handle, SCHED_FIFO, &param);
+			if(ret != 0) {
+				mdclog_write(MDCLOG_WARN, "Unable to set SCHED_FIFO priority %d on receiver thread %lu: %s", priority, i, strerror(ret));
+			}
+		}
+	}
+
+	if(cpus.size() < xapp_rcv_thread.size() && !cpus.empty()) {
+		mdclog_write(MDCLOG_WARN, "%lu receiver threads share %lu cpus", xapp_rcv_thread.size(), cpus.size());
+	}
+}
+
 void Xapp::shutdown(){
 	mdclog_write(MDCLOG_INFO, "Shutting down xapp %s", config_ref->operator[](XappSettings::SettingName::XAPP_ID).c_str());
 
+	int deadline_sec = std::stoi(DEFAULT_SHUTDOWN_DEADLINE);
+	try {
+		deadline_sec = std::stoi(config_ref->operator[](XappSettings::SettingName::SHUTDOWN_DEADLINE));
+	} catch (std::exception &e) {
+		mdclog_write(MDCLOG_WARN, "invalid shutdown deadline, using %d seconds", deadline_sec);
+	}
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(deadline_sec);
+
 	//send subscriptions delete.
-	shutdown_delete_subscriptions();
+	shutdown_delete_subscriptions(deadline);
 	// send deregistration request
-	shutdown_deregistration_request();
+	shutdown_deregistration_request(deadline);
 
-	sleep(2);
+	// let the receivers answer the indications still on their way, within the deadline
+	auto drain = std::min(deadline - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration(std::chrono::seconds(2)));
+	if (drain > std::chrono::steady_clock::duration::zero()) {
+		std::this_thread::sleep_for(drain);
+	}
 	rmr_ref->set_listen(false);
 
 	shutdown_http_listener();
@@ -126,21 +298,37 @@ void Xapp::shutdown(){
 	}
 	xapp_rcv_thread.clear();
 
+	stop_control_plane();
+
+	for (int stage = 0; stage < LATENCY_NUM_STAGES; stage++) {
+		mdclog_write(MDCLOG_INFO, "%s", latency_report((latency_stage_t) stage).c_str());
+	}
+
 	return;
 }
 
-inline void Xapp::subscribe_delete_request(string sub_id) {
-	auto delJson = pplx::create_task([sub_id, this]() {
-		utility::string_t port = U("8088");
-		utility::string_t address = U("http://service-ricplt-submgr-http.ricplt.svc.cluster.local:");
-		address.append(port);
-		address.append(U("/ric/v1/subscriptions/"));
-		address.append( utility::string_t(sub_id));
-		uri_builder uri(address);
-		auto addr = uri.to_uri().to_string();
-		http_client client(addr);
-		ucout << utility::string_t(U("making requests at: ")) << addr <<std::endl;
-		return client.request(methods::DEL);
+/*
+	Waits for the task until the deadline and then cancels its request. The shared clients keep
+	their own timeout, so requests that must end by a deadline are canceled instead.
+*/
+static pplx::task_status wait_until(pplx::task<void> &task, std::chrono::steady_clock::time_point deadline,
+		pplx::cancellation_token_source &cts) {
+	auto done = std::make_shared<std::promise<void>>();
+	auto finished = done->get_future();
+	task.then([done](pplx::task<void>) { done->set_value(); });
+	if (finished.wait_until(deadline) == std::future_status::timeout) {
+		cts.cancel();
+	}
+	return task.wait();
+}
+
+inline void Xapp::subscribe_delete_request(string sub_id, std::chrono::milliseconds timeout) {
+	pplx::cancellation_token_source cts;
+	auto delJson = pplx::create_task([sub_id, cts, this]() {
+		utility::string_t path = U("/ric/v1/subscriptions/");
+		path.append( utility::string_t(sub_id));
+		ucout << utility::string_t(U("making requests at: ")) << http_pool->endpoint(HTTP_SUBMGR) << path <<std::endl;
+		return http_pool->client(HTTP_SUBMGR).request(methods::DEL, path, cts.get_token());
 	})
 
 	// Get the response.
@@ -154,27 +342,87 @@ inline void Xapp::subscribe_delete_request(string sub_id) {
 	});
 
 	try {
-		delJson.wait();
+		if (wait_until(delJson, std::chrono::steady_clock::now() + timeout, cts) == pplx::canceled) {
+			throw std::runtime_error("canceled at the shutdown deadline");
+		}
 	}
 	catch (const std::exception& e) {
 		mdclog_write(MDCLOG_ERR, "Subscription delete exception: %s", e.what());
+		throw;
 	}
 }
 
-void Xapp::shutdown_delete_subscriptions() {
+/*
+	Deletes the subscriptions with up to SUBSCRIPTION_CONCURRENCY requests in flight. No request
+	is started or left waiting past the deadline; the subscriptions that could not be deleted are
+	reported, and remain in subscription_map, so that they can be cleaned up from submgr.
+*/
+void Xapp::shutdown_delete_subscriptions(std::chrono::steady_clock::time_point deadline) {
 	std::string xapp_id = config_ref->operator [](XappSettings::SettingName::XAPP_ID);
 
 	mdclog_write(MDCLOG_INFO,"Preparing to send subscription Delete in file=%s, line=%d",__FILE__,__LINE__);
 
-	size_t len = subscription_map.size();
+	std::vector<std::pair<std::string, std::string>> subs;
+	{
+		std::lock_guard<std::mutex> guard(subscription_mutex);
+		subs.assign(subscription_map.begin(), subscription_map.end());
+	}
+	size_t len = subs.size();
 	mdclog_write(MDCLOG_INFO,"E2 NodeB List size : %lu", len);
+	if (len == 0) {
+		return;
+	}
 
-	size_t i = 1;
-	for (auto subs : subscription_map) {
-		sleep(5);
-		mdclog_write(MDCLOG_INFO,"sending subscription delete request %lu out of %lu to meid %s", i, len, subs.first.c_str());
-		subscribe_delete_request(subs.second);
+	size_t concurrency = 1;
+	try {
+		concurrency = std::max(1, std::stoi(config_ref->operator[](XappSettings::SettingName::SUBSCRIPTION_CONCURRENCY)));
+	} catch (std::exception &e) {
+		mdclog_write(MDCLOG_WARN, "invalid subscription concurrency, sending one request at a time");
+	}
+	concurrency = std::min(concurrency, len);
+
+	auto started = std::chrono::steady_clock::now();
+	std::atomic<size_t> next(0);
+	std::vector<std::string> undeleted(len);	// reason per subscription, empty once deleted
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < concurrency; i++) {
+		workers.emplace_back([this, &subs, &next, &undeleted, len, deadline]() {
+			size_t index;
+			while ((index = next.fetch_add(1)) < len) {
+				auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+				if (remaining.count() <= 0) {
+					undeleted[index] = "shutdown deadline reached before the request was sent";
+					continue;
+				}
+
+				mdclog_write(MDCLOG_INFO,"sending subscription delete request %lu out of %lu to meid %s", index + 1, len, subs[index].first.c_str());
+				try {
+					subscribe_delete_request(subs[index].second, remaining);
+				} catch (const std::exception &e) {
+					undeleted[index] = e.what();
+					continue;
+				}
+
+				std::lock_guard<std::mutex> guard(subscription_mutex);
+				subscription_map.erase(subs[index].first);
+				subscription_state.erase(subs[index].second);
+			}
+		});
+	}
+	for (auto &worker : workers) {
+		worker.join();
+	}
+
+	size_t failed = 0;
+	for (size_t i = 0; i < len; i++) {
+		if (!undeleted[i].empty()) {
+			mdclog_write(MDCLOG_ERR, "Subscription %s of meid %s was not deleted: %s", subs[i].second.c_str(), subs[i].first.c_str(), undeleted[i].c_str());
+			failed++;
+		}
 	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+	mdclog_write(failed ? MDCLOG_ERR : MDCLOG_INFO, "Deleted %lu out of %lu subscriptions in %ld ms, %lu left in submgr",
+			len - failed, len, (long)elapsed.count(), failed);
 
 		/*
 
@@ -290,16 +538,9 @@ void Xapp::startup_subscribe_kpm_requests(void ){
 			s << jsonObject.dump().c_str();
 			web::json::value ret = json::value::parse(s);
 			// std::wcout << ret.serialize().c_str() << std::endl;
-			utility::string_t port = U("8088");
-			utility::string_t address = U("http://service-ricplt-submgr-http.ricplt.svc.cluster.local:");
-			address.append(port);
-			address.append(U("/ric/v1/subscriptions"));
-			uri_builder uri(address);
-			auto addr = uri.to_uri().to_string();
-			http_client client(addr);
-			//std::cout<<uri::validate(addr)<<" validation \n";
-			ucout << utility::string_t(U("making requests at: ")) << addr << "\n";
-			return client.request(methods::POST,U("/"),ret.serialize(),U("application/json"));
+			utility::string_t path = U("/ric/v1/subscriptions");
+			ucout << utility::string_t(U("making requests at: ")) << http_pool->endpoint(HTTP_SUBMGR) << path << "\n";
+			return http_pool->client(HTTP_SUBMGR).request(methods::POST,path,ret.serialize(),U("application/json"));
 		})
 
 		// Get the response.
@@ -434,18 +675,11 @@ inline void Xapp::subscribe_request(string meid) {
 		s << jsonObject.dump().c_str();
 		web::json::value ret = json::value::parse(s);
 		// std::wcout << ret.serialize().c_str() << std::endl;
-		utility::string_t port = U("8088");
-		utility::string_t address = U("http://service-ricplt-submgr-http.ricplt.svc.cluster.local:");
-		address.append(port);
-		address.append(U("/ric/v1/subscriptions"));
-		uri_builder uri(address);
-		auto addr = uri.to_uri().to_string();
-		http_client client(addr);
-		//std::cout<<uri::validate(addr)<<" validation \n";
-
-		ucout << utility::string_t(U("making requests at: ")) << addr << "\n";
-
-		return client.request(methods::POST,U("/"),ret.serialize(),U("application/json"));
+		utility::string_t path = U("/ric/v1/subscriptions");
+
+		ucout << utility::string_t(U("making requests at: ")) << http_pool->endpoint(HTTP_SUBMGR) << path << "\n";
+
+		return http_pool->client(HTTP_SUBMGR).request(methods::POST,path,ret.serialize(),U("application/json"));
 	})
 
 	// Get the response.
@@ -467,7 +701,16 @@ inline void Xapp::subscribe_request(string meid) {
 
 			std::string tmp;
 			tmp = jsonObject[U("SubscriptionId")].as_string();
-			subscription_map.emplace(std::make_pair(meid, tmp));
+
+			std::lock_guard<std::mutex> guard(subscription_mutex);
+			auto known = subscription_map.find(meid);
+			if (known != subscription_map.end()) {	// replaces the subscription of an earlier attempt
+				subscription_state.erase(known->second);
+				known->second = tmp;
+			} else {
+				subscription_map.emplace(std::make_pair(meid, tmp));
+			}
+			subscription_state.emplace(tmp, SUBSCRIPTION_PENDING);	// the notification may already have arrived
 	});
 
 	try
@@ -481,6 +724,74 @@ inline void Xapp::subscribe_request(string meid) {
 	}
 }
 
+/*
+	Sends the subscription request of the E2 node, retrying with exponential backoff.
+	The delay is drawn from the upper half of the backoff window so that nodes failing
+	together (e.g. submgr not yet aware of our registration) do not retry in lockstep.
+*/
+void Xapp::subscribe_with_retries(const string &meid) {
+	thread_local std::mt19937 rng(std::random_device{}());
+	int backoff = SUBSCRIPTION_BACKOFF_MS;
+
+	for (int attempt = 1; attempt <= MAX_SUBSCRIPTION_ATTEMPTS; attempt++) {
+		try {
+			subscribe_request(meid);
+			return;
+		} catch (const std::exception &e) {
+			if (attempt == MAX_SUBSCRIPTION_ATTEMPTS) {
+				break;
+			}
+			std::uniform_int_distribution<int> jitter(backoff / 2, backoff);
+			int delay = jitter(rng);
+			mdclog_write(MDCLOG_WARN, "subscription attempt %d to meid %s failed, retrying in %d ms", attempt, meid.c_str(), delay);
+			std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+			backoff = std::min(backoff * 2, SUBSCRIPTION_BACKOFF_MAX_MS);
+		}
+	}
+	mdclog_write(MDCLOG_ERR, "giving up subscribing to meid %s after %d attempts", meid.c_str(), MAX_SUBSCRIPTION_ATTEMPTS);
+}
+
+/*
+	Records the outcome of a subscription reported by submgr. Returns true when every
+	subscription has failed and none is left in flight, so the xapp has nothing to serve.
+*/
+bool Xapp::subscription_notified(const string &sub_id, bool failed) {
+	std::lock_guard<std::mutex> guard(subscription_mutex);
+
+	auto state = subscription_state.find(sub_id);
+	if (state != subscription_state.end()) {
+		state->second = failed ? SUBSCRIPTION_FAILED : SUBSCRIPTION_CONFIRMED;
+	} else if (subscribe_outstanding > 0) {	// may arrive before the response to its request
+		subscription_state.emplace(sub_id, failed ? SUBSCRIPTION_FAILED : SUBSCRIPTION_CONFIRMED);
+	} else {
+		mdclog_write(MDCLOG_WARN, "notification for unknown subscription %s", sub_id.c_str());
+		return false;
+	}
+	subscription_cv.notify_all();
+
+	if (!failed || subscribe_outstanding > 0) {
+		return false;
+	}
+	for (auto &entry : subscription_state) {
+		if (entry.second != SUBSCRIPTION_FAILED) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Accepted subscriptions whose notification has not arrived yet, subscription_mutex must be held.
+size_t Xapp::subscriptions_pending(void) {
+	size_t pending = 0;
+	for (auto &subs : subscription_map) {
+		auto state = subscription_state.find(subs.second);
+		if (state == subscription_state.end() || state->second == SUBSCRIPTION_PENDING) {
+			pending++;
+		}
+	}
+	return pending;
+}
+
 void Xapp::startup_subscribe_rc_requests(){
 	mdclog_write(MDCLOG_INFO, "Preparing to send subscription in file=%s, line=%d", __FILE__, __LINE__);
 
@@ -505,6 +816,7 @@ void Xapp::startup_subscribe_rc_requests(){
 		}
 	}
 
+	std::vector<std::string> meids;
 	for (auto e2node : e2node_map) {
 		if (!nodebid.empty()) {
 			auto e2plmn = e2node.second[U("plmnId")].as_string();
@@ -527,15 +839,80 @@ void Xapp::startup_subscribe_rc_requests(){
 				throw std::runtime_error(ss.str());
 			}
 		}
-		sleep(5);	// FIXME wait for registration to complete OR pause required between each subscription
-		subscribe_request(e2node.first); // FIXME this can be called only after the xApp has been registered
+		meids.push_back(e2node.first);
 
 		if (!nodebid.empty()) {	// we only reach here when it's not empty when we found the nodebId to subscribe and we no longer need to iterate over the map
-			break;	// avoids sleeping over remaining e2node list
+			break;
+		}
+	}
+
+	/*
+		Registration has completed by now, submgr rejecting an early request is covered by the retries.
+		Up to SUBSCRIPTION_CONCURRENCY requests are in flight, each worker takes the next node once its
+		request has been answered.
+	*/
+	size_t concurrency = 1;
+	try {
+		concurrency = std::max(1, std::stoi(config_ref->operator[](XappSettings::SettingName::SUBSCRIPTION_CONCURRENCY)));
+	} catch (std::exception &e) {
+		mdclog_write(MDCLOG_WARN, "invalid subscription concurrency, sending one request at a time");
+	}
+	concurrency = std::min(concurrency, meids.size());
+
+	{
+		std::lock_guard<std::mutex> guard(subscription_mutex);
+		subscribe_outstanding = meids.size();
+	}
+	mdclog_write(MDCLOG_INFO, "Subscribing to %lu E2 nodes with %lu requests in flight", meids.size(), concurrency);
+
+	auto started = std::chrono::steady_clock::now();
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < concurrency; i++) {
+		workers.emplace_back([this, &meids, &next]() {
+			size_t index;
+			while ((index = next.fetch_add(1)) < meids.size()) {
+				subscribe_with_retries(meids[index]);
+
+				std::lock_guard<std::mutex> guard(subscription_mutex);
+				subscribe_outstanding--;
+			}
+		});
+	}
+	for (auto &worker : workers) {
+		worker.join();
+	}
+
+	std::unique_lock<std::mutex> lock(subscription_mutex);
+	subscription_cv.wait_for(lock, std::chrono::seconds(SUBSCRIPTION_CONFIRM_TIMEOUT), [this]() { return subscriptions_pending() == 0; });
+
+	// forget the notifications of requests that were not accepted, only live subscriptions are tracked
+	std::unordered_set<std::string> live;
+	for (auto &subs : subscription_map) {
+		live.insert(subs.second);
+	}
+	for (auto state = subscription_state.begin(); state != subscription_state.end(); ) {
+		if (live.count(state->first) == 0) {
+			state = subscription_state.erase(state);
+		} else {
+			++state;
+		}
+	}
+
+	size_t accepted = subscription_map.size();
+	size_t pending = subscriptions_pending();
+	size_t failed = 0;
+	for (auto &subs : subscription_map) {
+		auto state = subscription_state.find(subs.second);
+		if (state != subscription_state.end() && state->second == SUBSCRIPTION_FAILED) {
+			failed++;
 		}
 	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+	mdclog_write(MDCLOG_INFO, "Subscriptions to %lu E2 nodes in %ld ms: %lu accepted, %lu confirmed, %lu failed, %lu awaiting notification",
+			meids.size(), (long)elapsed.count(), accepted, accepted - pending - failed, failed, pending);
 
-	if (subscription_map.size() == 0) {
+	if (accepted == 0 || failed == accepted) {
 		throw std::runtime_error("Unable to subscribe to E2 NodeB");
 	}
 }
@@ -617,15 +994,11 @@ void Xapp::fetch_connected_nodeb_list() {
 
 	pplx::create_task([this]()
 		{
-			utility::string_t address = U("http://service-ricplt-e2mgr-http.ricplt.svc.cluster.local:3800");
-			address.append(U("/v1/nodeb/states"));
-			uri_builder uri(address);
-			auto addr = uri.to_uri().to_string();
-			http_client client(addr);
+			utility::string_t path = U("/v1/nodeb/states");
 
-			mdclog_write(MDCLOG_INFO, "sending request for E2 NodeB list at: %s", addr.c_str());
+			mdclog_write(MDCLOG_INFO, "sending request for E2 NodeB list at: %s%s", http_pool->endpoint(HTTP_E2MGR).c_str(), path.c_str());
 
-			return client.request(methods::GET,U("/"), U("accept: application/json"));
+			return http_pool->client(HTTP_E2MGR).request(methods::GET,path, U("accept: application/json"));
 		})
 		// Get the response.
 		.then([this](http_response response)
@@ -693,7 +1066,7 @@ void Xapp::startup_registration_request() {
 		http_addr.append(":" + http_port);
 	}
 
-	pplx::create_task([xapp_name, version, config_path, xapp_id, http_addr, rmr_addr, config_str]()
+	pplx::create_task([xapp_name, version, config_path, xapp_id, http_addr, rmr_addr, config_str, this]()
 		{
 			jsonn jObj;
 			jObj = {
@@ -713,17 +1086,12 @@ void Xapp::startup_registration_request() {
 			s << jObj.dump().c_str();
 			web::json::value ret = json::value::parse(s);
 
-			utility::string_t port = U("8080");
-			utility::string_t address = U("http://service-ricplt-appmgr-http.ricplt.svc.cluster.local:");
-			address.append(port);
-			address.append(U("/ric/v1/register"));
-			uri_builder uri(address);
-			auto addr = uri.to_uri().to_string();
-			http_client client(addr);
+			utility::string_t path = U("/ric/v1/register");
+			auto &client = http_pool->client(HTTP_APPMGR);
 
-			mdclog_write(MDCLOG_INFO, "sending registration request at: %s", addr.c_str());
+			mdclog_write(MDCLOG_INFO, "sending registration request at: %s%s", http_pool->endpoint(HTTP_APPMGR).c_str(), path.c_str());
 
-			return client.request(methods::POST,U("/"),ret.serialize(),U("application/json"));
+			return client.request(methods::POST,path,ret.serialize(),U("application/json"));
 		})
 
 		// Get the response.
@@ -750,13 +1118,14 @@ void Xapp::startup_registration_request() {
 		}).get();	// get allows rethrowing exceptions from task
 }
 
-void Xapp::shutdown_deregistration_request() {
+void Xapp::shutdown_deregistration_request(std::chrono::steady_clock::time_point deadline) {
 	mdclog_write(MDCLOG_INFO, "Preparing deregistration request");
 
 	string xapp_name = config_ref->operator[](XappSettings::SettingName::XAPP_NAME);
 	string xapp_id = config_ref->operator[](XappSettings::SettingName::XAPP_ID);
 
-	pplx::create_task([xapp_name, xapp_id]()
+	pplx::cancellation_token_source cts;
+	auto deregistration = pplx::create_task([xapp_name, xapp_id, cts, this]()
 		{
 			jsonn jObj;
 			jObj = {
@@ -771,17 +1140,12 @@ void Xapp::shutdown_deregistration_request() {
 			s << jObj.dump().c_str();
 			web::json::value ret = json::value::parse(s);
 
-			utility::string_t port = U("8080");
-			utility::string_t address = U("http://service-ricplt-appmgr-http.ricplt.svc.cluster.local:");
-			address.append(port);
-			address.append(U("/ric/v1/deregister"));
-			uri_builder uri(address);
-			auto addr = uri.to_uri().to_string();
-			http_client client(addr);
+			utility::string_t path = U("/ric/v1/deregister");
+			auto &client = http_pool->client(HTTP_APPMGR);
 
-			mdclog_write(MDCLOG_INFO, "sending deregistration request at: %s", addr.c_str());
+			mdclog_write(MDCLOG_INFO, "sending deregistration request at: %s%s", http_pool->endpoint(HTTP_APPMGR).c_str(), path.c_str());
 
-			return client.request(methods::POST,U("/"),ret.serialize(),U("application/json"));
+			return client.request(methods::POST,path,ret.serialize(),U("application/json"),cts.get_token());
 		})
 
 		// Get the response.
@@ -800,11 +1164,16 @@ void Xapp::shutdown_deregistration_request() {
 		.then([](pplx::task<void> previousTask)
 		{
 			try {
-				previousTask.wait();
+				if (previousTask.wait() == pplx::canceled) {
+					mdclog_write(MDCLOG_ERR, "deregistration canceled at the shutdown deadline");
+				}
 			} catch (exception& e) {
 				mdclog_write(MDCLOG_ERR, "deregistration exception: %s", e.what());
 			}
 		});
+
+	// the shared client must not be released while the request is in flight
+	wait_until(deregistration, deadline, cts);
 }
 
 void Xapp::handle_error(pplx::task<void>& t, const utility::string_t msg) {
@@ -832,18 +1201,30 @@ void Xapp::handle_request(http_request request) {
 				answer = task.get();
 				mdclog_write(MDCLOG_INFO, "Received REST notification %s", answer.serialize().c_str());
 
+				std::string sub_id;
+				if (answer.has_field(U("SubscriptionId"))) {
+					sub_id = answer[U("SubscriptionId")].as_string();
+				}
+
+				bool failed = false;
 				auto subscriptions = answer[U("SubscriptionInstances")].as_array();
 				for (auto sub : subscriptions) {
 					int event = sub[U("E2EventInstanceId")].as_integer();
 					if (event == 0) {				// this is an error message, unable to subscribe to this event
 						auto source = sub[U("ErrorSource")].as_string();
 						auto cause = sub[U("ErrorCause")].as_string();
-						mdclog_write(MDCLOG_ERR, "unable to complete subscription. ErrorSource: %s, ErrorCause: %s", source.c_str(), cause.c_str());
-						kill(getpid(), SIGTERM);	// sending signal to shutdown the application
+						mdclog_write(MDCLOG_ERR, "unable to complete subscription %s. ErrorSource: %s, ErrorCause: %s", sub_id.c_str(), source.c_str(), cause.c_str());
+						failed = true;
 						break;
 					}
 				}
 
+				// only give up when no E2 node is left to serve
+				if (subscription_notified(sub_id, failed)) {
+					mdclog_write(MDCLOG_ERR, "all subscriptions have failed");
+					kill(getpid(), SIGTERM);	// sending signal to shutdown the application
+				}
+
 				request.reply(status_codes::OK)
 					.then([this](pplx::task<void> t)
 					{
@@ -864,6 +1245,60 @@ void Xapp::handle_request(http_request request) {
 
 }
 
+/*
+	Serves the counters, queue depths and latency histograms in the Prometheus text format.
+	Per thread counters are only summed up here, so scrapes never slow down the receivers.
+*/
+void Xapp::handle_metrics(http_request request) {
+	std::stringstream body;
+	write_metrics(body);
+
+	request.reply(status_codes::OK, body.str(), "text/plain; version=0.0.4; charset=utf-8")
+		.then([this](pplx::task<void> t)
+		{
+			handle_error(t, "http reply exception");
+		});
+}
+
+void Xapp::write_metrics(std::ostream &out) {
+	metrics_write_counters(out);
+
+	metrics_write_header(out, "xapp_rmr_retries_total", "counter", "RMR send attempts made by the retry queue.");
+	out << "xapp_rmr_retries_total " << rmr_ref->get_retries() << "\n";
+
+	metrics_write_header(out, "xapp_rmr_dropped_total", "counter", "RMR messages dropped by the retry queue.");
+	out << "xapp_rmr_dropped_total " << rmr_ref->get_dropped() << "\n";
+
+	metrics_write_header(out, "xapp_rmr_retry_queue_depth", "gauge", "RMR messages waiting for a retry.");
+	out << "xapp_rmr_retry_queue_depth " << rmr_ref->get_retry_pending() << "\n";
+
+	if (xapp_mutex != NULL) {
+		std::lock_guard<std::mutex> guard(*xapp_mutex);	// receivers may still be starting up
+
+		if (control_plane) {
+			metrics_write_header(out, "xapp_control_queue_depth", "gauge", "Messages queued for the control-plane thread.");
+			out << "xapp_control_queue_depth " << control_plane->get_queue_depth() << "\n";
+		}
+
+		if (dispatcher) {
+			metrics_write_header(out, "xapp_dispatcher_queue_depth", "gauge", "Messages queued for each dispatcher worker.");
+			for (size_t i = 0; i < dispatcher->get_num_workers(); i++) {
+				out << "xapp_dispatcher_queue_depth{worker=\"" << i << "\"} " << dispatcher->get_queue_depth(i) << "\n";
+			}
+		}
+
+		if (pipeline) {
+			static const char *stages[PIPELINE_NUM_STAGES] = { "decode", "encode", "send" };
+			metrics_write_header(out, "xapp_pipeline_queue_depth", "gauge", "Messages queued for each pipeline stage.");
+			for (int i = 0; i < PIPELINE_NUM_STAGES; i++) {
+				out << "xapp_pipeline_queue_depth{stage=\"" << stages[i] << "\"} " << pipeline->get_queue_depth((pipeline_stage_t) i) << "\n";
+			}
+		}
+	}
+
+	metrics_write_latency(out);
+}
+
 void Xapp::startup_http_listener() {
 	mdclog_write(MDCLOG_INFO, "Starting up HTTP Listener");
 
@@ -883,10 +1318,20 @@ void Xapp::startup_http_listener() {
 
 	listener->support(methods::POST,[this](http_request request) { handle_request(request); });
 	listener->support(methods::PUT,[this](http_request request){ handle_request(request); });
+
+	// served by the same port, cpprest dispatches each request to the listener of its path
+	uri_builder metrics_uri(U("http://0.0.0.0:") + port + U("/metrics"));
+	metrics_listener = make_unique<http_listener>(metrics_uri.to_uri());
+	metrics_listener->support(methods::GET,[this](http_request request) { handle_metrics(request); });
+	mdclog_write(MDCLOG_INFO, "Serving metrics at: %s", metrics_uri.to_uri().to_string().c_str());
+
 	try {
 		listener
 			->open()
 			.wait();	// non-blocking operation
+		metrics_listener
+			->open()
+			.wait();
 
 	} catch (exception const &e) {
 		mdclog_write(MDCLOG_ERR, "startup http listener exception: %s", e.what());
@@ -899,6 +1344,7 @@ void Xapp::shutdown_http_listener() {
 
 	try {
 		listener->close().wait();
+		metrics_listener->close().wait();
 
 	} catch (exception const &e) {
 		mdclog_write(MDCLOG_ERR, "shutdown http listener exception: %s", e.what());
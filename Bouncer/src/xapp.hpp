@@ -30,9 +30,17 @@
 #include <pthread.h>
 #include <unordered_map>
 #include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
 #include <cpprest/http_listener.h>
 #include <cpprest/http_msg.h>
 #include "xapp_rmr.hpp"
+#include "xapp_dispatcher.hpp"
+#include "xapp_pipeline.hpp"
+#include "xapp_control_plane.hpp"
+#include "xapp_metrics.hpp"
+#include "xapp_http_pool.hpp"
 #include "xapp_sdl.hpp"
 #include "rapidjson/writer.h"
 #include "rapidjson/document.h"
@@ -81,28 +89,52 @@ public:
 private:
   void startup_subscribe_kpm_requests(void);
   void startup_subscribe_rc_requests();
-  void shutdown_delete_subscriptions(void);
+  void shutdown_delete_subscriptions(std::chrono::steady_clock::time_point);
   void startup_get_policies(void );
   void startup_registration_request();
-  void shutdown_deregistration_request();
+  void shutdown_deregistration_request(std::chrono::steady_clock::time_point);
   inline void subscribe_request(string);
-  inline void subscribe_delete_request(string);
+  void subscribe_with_retries(const string &);
+  bool subscription_notified(const string &, bool);
+  size_t subscriptions_pending(void);
+  inline void subscribe_delete_request(string, std::chrono::milliseconds);
   void startup_http_listener();
   void shutdown_http_listener();
   void handle_request(http_request request);
+  void handle_metrics(http_request request);
+  void write_metrics(std::ostream &);
   void handle_error(pplx::task<void>& t, const utility::string_t msg);
+  void configure_receiver_threads(void);
+  void start_control_plane(XappMsgHandler &);
+  void stop_control_plane(void);
 
 
   XappRmr * rmr_ref;
   XappSettings * config_ref;
   SubscriptionHandler *subhandler_ref;
   std::unique_ptr<http_listener> listener;
+  std::unique_ptr<http_listener> metrics_listener;
+  std::unique_ptr<XappHttpPool> http_pool;
 
   std::mutex *xapp_mutex;
   std::vector<std::thread> xapp_rcv_thread;
+  std::unique_ptr<XappDispatcher<XappMsgHandler>> dispatcher;
+  std::unique_ptr<XappPipeline> pipeline;
+  std::unique_ptr<XappControlPlane> control_plane;
+  std::thread control_thread;
   std::vector<std::string> rnib_gnblist;
   std::vector<XappMsgHandler> _callbacks;
+  typedef enum {
+	  SUBSCRIPTION_PENDING,
+	  SUBSCRIPTION_CONFIRMED,
+	  SUBSCRIPTION_FAILED
+  } subscription_state_t;
+
+  std::mutex subscription_mutex;	// guards subscription_map, subscription_state and subscribe_outstanding
+  std::condition_variable subscription_cv;
   std::unordered_map<std::string, std::string> subscription_map;
+  std::unordered_map<std::string, subscription_state_t> subscription_state;	// live subscriptions by SubscriptionId, set by the submgr notifications
+  size_t subscribe_outstanding;	// E2 nodes whose subscription request has not been answered yet
   std::unordered_map<std::string, web::json::value> e2node_map;
 };
 
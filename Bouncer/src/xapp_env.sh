@@ -4,6 +4,19 @@ export RMR_SEED_RT="../init/routes.txt"
 # export RMR_RTG_SVC="9999"
 export MSG_MAX_BUFFER="2072"
 export THREADS="1"
+export BUSY_POLL="0"
+# export CPU_AFFINITY="2-5"
+# export SCHED_PRIORITY="50"
+export RECEIVER_MODE="sharded"
+export PIPELINE_THREADS="1,1,1"
+export CONTROL_ENCODER="fast"
+export RETRY_QUEUE_SIZE="1024"
+export RETRY_DROP_POLICY="oldest"
+export SUBSCRIPTION_CONCURRENCY="16"
+export SHUTDOWN_DEADLINE="20"
+# export SUBMGR_ENDPOINT="http://localhost:8088"
+# export APPMGR_ENDPOINT="http://localhost:8080"
+# export E2MGR_ENDPOINT="http://localhost:3800"
 export VERBOSE="0"
 export CONFIG_FILE="../init/config-file.json"
 export CONFIG_MAP_NAME="../init/config-map.yaml"